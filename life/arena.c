@@ -0,0 +1,237 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Arenas for the engines' grids. An engine works out how much memory it needs
+for all of its grids, maps it in one go with arena_create() and carves the
+grids out of it with arena_alloc(), which is only a bump of an offset; it all
+goes back in one munmap() when the engine is destroyed.
+
+A 2 MiB page needs a 2 MiB aligned range of virtual memory, which mmap() does
+not promise, so an arena of at least that size is mapped with 2 MiB to spare
+and trimmed down to an aligned range, which madvise(MADV_HUGEPAGE) then asks
+to be backed by transparent huge pages. That is one TLB entry for every 512
+of ordinary pages, and one fault where there were 512. With --huge-pages
+hugetlb the pages come from the pool reserved in /proc/sys/vm/nr_hugepages
+instead, and from THP if the pool is empty. With --prefault every page is
+faulted in as soon as it is allocated, so the first generations do not pay for
+it.
+
+With --numa each grid is cut into as many bands as there are threads, and
+mbind() asks for the pages of each band to come from the node of the thread
+that computes those rows, whichever thread happens to touch them first (which
+is mostly the main thread, loading the pattern). Grids are laid out row by
+row, so a fraction of a grid's bytes is the same fraction of its rows, give
+or take the border. Band boundaries are rounded to whole pages, and to whole
+huge pages where there are some, as splitting one would undo them.
+*/
+
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "arena.h"
+
+#define HUGE_PAGE (2UL << 20)
+// Words in the node masks given to mbind(), enough for 1024 nodes.
+#define ARENA_NODE_WORDS 16
+
+static const char *const huge_pages_names[] = {
+  [HUGE_PAGES_OFF] = "off",
+  [HUGE_PAGES_THP] = "thp",
+  [HUGE_PAGES_HUGETLB] = "hugetlb",
+};
+
+struct arena {
+  struct arena_config config;
+  char *base;
+  unsigned long length;
+  // Bytes handed out so far, from base.
+  unsigned long used;
+  // Size of the pages that the arena is mapped with, or asked to be.
+  unsigned long page;
+};
+
+bool
+find_huge_pages (const char *name, enum huge_pages *huge_pages)
+{
+  for (unsigned long i = 0; i < sizeof(huge_pages_names) / sizeof(huge_pages_names[0]); i++) {
+    if (0 == strcmp(huge_pages_names[i], name)) {
+      *huge_pages = (enum huge_pages)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+static char *
+arena_map (const unsigned long length, const int flags)
+{
+  return mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+}
+
+// Maps length bytes, a multiple of HUGE_PAGE, starting on a multiple of HUGE_PAGE.
+static char *
+arena_map_aligned (const unsigned long length)
+{
+  char *map = arena_map(length + HUGE_PAGE, 0);
+  if (MAP_FAILED == map)
+    return map;
+
+  const uintptr_t start = (uintptr_t)map;
+  char *base = map + ((HUGE_PAGE - start % HUGE_PAGE) % HUGE_PAGE);
+  if (base > map)
+    munmap(map, (size_t)(base - map));
+  if (base + length < map + length + HUGE_PAGE)
+    munmap(base + length, (size_t)(map + length + HUGE_PAGE - (base + length)));
+  return base;
+}
+
+// Faults in every page of [base, base + length).
+static void
+arena_prefault (char *base, const unsigned long length)
+{
+#ifdef MADV_POPULATE_WRITE
+  if (0 == madvise(base, length, MADV_POPULATE_WRITE))
+    return;
+#endif
+  // Kernels before 5.14: a write to every page does the same.
+  volatile char *cells = base;
+  const unsigned long page = (unsigned long)sysconf(_SC_PAGESIZE);
+  for (unsigned long offset = 0; offset < length; offset += page)
+    cells[offset] = 0;
+}
+
+// Asks for the pages of [start, start + length) to come from node.
+static void
+arena_bind (char *start, const unsigned long length, const int node)
+{
+  unsigned long mask[ARENA_NODE_WORDS] = { 0 };
+  if (node < 0 || node >= ARENA_NODE_WORDS * 64 || 0 == length)
+    return;
+  mask[node / 64] |= 1UL << (node % 64);
+
+  // Preferred rather than bound, so that a full node spills over instead of failing.
+  static bool warned = false;
+  if (0 != syscall(SYS_mbind, start, length, MPOL_PREFERRED, mask, ARENA_NODE_WORDS * 64 + 1, 0) && !warned) {
+    fprintf(stderr, "Could not place memory on NUMA node %d: %s\n", node, strerror(errno));
+    warned = true;
+  }
+}
+
+// Rounds the address of cells down to a page of the arena.
+static char *
+arena_page_start (const struct arena *arena, char *cells)
+{
+  return arena->base + (unsigned long)(cells - arena->base) / arena->page * arena->page;
+}
+
+// Spreads the pages of the grid at [grid, grid + bytes) over the nodes of the bands.
+static void
+arena_place (const struct arena *arena, char *grid, const unsigned long bytes)
+{
+  const unsigned long bands = arena->config.bands;
+  char *start = arena_page_start(arena, grid);
+  for (unsigned long band = 0; band < bands; band++) {
+    // Each boundary goes to the nearest page boundary; the last one takes in the rest of its page.
+    char *end = band + 1 < bands ? arena_page_start(arena, grid + bytes * (band + 1) / bands + arena->page / 2)
+                                 : arena_page_start(arena, grid + bytes + arena->page - 1);
+    if (end > start) {
+      arena_bind(start, (unsigned long)(end - start), arena->config.band_nodes[band]);
+      start = end;
+    }
+  }
+}
+
+struct arena *
+arena_create (const struct arena_config *config, const unsigned long bytes)
+{
+  const unsigned long page = (unsigned long)sysconf(_SC_PAGESIZE);
+  struct arena *arena = malloc(sizeof(*arena));
+  arena->config = *config;
+  arena->page = page;
+  arena->length = bytes > 0 ? (bytes + page - 1) / page * page : page;
+  arena->used = 0;
+  arena->base = MAP_FAILED;
+
+  // Less than a huge page could never be backed by one.
+  if (HUGE_PAGES_OFF == config->huge_pages || arena->length < HUGE_PAGE) {
+    arena->base = arena_map(arena->length, 0);
+  } else {
+    arena->length = (arena->length + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+    arena->page = HUGE_PAGE;
+#ifdef MAP_HUGETLB
+    if (HUGE_PAGES_HUGETLB == config->huge_pages) {
+      arena->base = arena_map(arena->length, MAP_HUGETLB);
+      static bool warned = false;
+      if (MAP_FAILED == arena->base && !warned) {
+        fprintf(stderr, "No huge pages to spare in /proc/sys/vm/nr_hugepages; using transparent huge pages\n");
+        warned = true;
+      }
+    }
+#endif
+    if (MAP_FAILED == arena->base) {
+      arena->base = arena_map_aligned(arena->length);
+#ifdef MADV_HUGEPAGE
+      // Fails only where THP is not built in, which leaves ordinary pages.
+      if (MAP_FAILED != arena->base)
+        madvise(arena->base, arena->length, MADV_HUGEPAGE);
+#endif
+    }
+  }
+
+  if (MAP_FAILED == arena->base) {
+    fprintf(stderr, "Could not map %lu bytes for the world: %s\n", arena->length, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  return arena;
+}
+
+void *
+arena_alloc (struct arena *arena, const unsigned long bytes, const unsigned long grids)
+{
+  assert(arena->used + arena_bytes(bytes) <= arena->length);
+  char *cells = arena->base + arena->used;
+  arena->used += arena_bytes(bytes);
+
+  if (NULL != arena->config.band_nodes) {
+    for (unsigned long i = 0; i < grids; i++)
+      arena_place(arena, cells + i * (bytes / grids), bytes / grids);
+  }
+  // Faulting the pages in places them, so it comes after arena_place().
+  if (arena->config.prefault && bytes > 0) {
+    char *start = arena_page_start(arena, cells);
+    arena_prefault(start, (unsigned long)(arena_page_start(arena, cells + bytes + arena->page - 1) - start));
+  }
+  return cells;
+}
+
+void
+arena_destroy (struct arena *arena)
+{
+  munmap(arena->base, arena->length);
+  free(arena);
+}
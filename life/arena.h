@@ -0,0 +1,75 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIFE_ARENA_H
+#define __LIFE_ARENA_H
+
+#include <stdbool.h>
+
+// What --huge-pages can ask for.
+enum huge_pages {
+  // Ordinary pages.
+  HUGE_PAGES_OFF,
+  // Transparent huge pages, asked for with madvise(MADV_HUGEPAGE).
+  HUGE_PAGES_THP,
+  // Huge pages from the hugetlbfs pool (MAP_HUGETLB), or THP if it has none to spare.
+  HUGE_PAGES_HUGETLB,
+};
+
+// How engines map their arenas; part of struct life_config.
+struct arena_config {
+  enum huge_pages huge_pages;
+  // Fault every page in when it is allocated, rather than on first touch.
+  bool prefault;
+  /* With --numa: grids are split into bands equal bands of rows, and band b
+     is kept on node band_nodes[b], that of the thread that computes it. NULL
+     leaves it to the kernel, which puts a page where it is first touched. */
+  unsigned long bands;
+  const int *band_nodes;
+};
+
+// Every allocation from an arena starts on a multiple of this many bytes.
+#define ARENA_ALIGN 64UL
+
+/* One mapping that an engine carves all of its grids out of, so that they are
+   allocated once, start on huge page boundaries and can be backed by huge
+   pages. The memory goes back when the arena is destroyed, not before. */
+struct arena;
+
+// Looks a --huge-pages name up; returns false if there is no such setting.
+bool find_huge_pages (const char *name, enum huge_pages *huge_pages);
+
+// Bytes that arena_alloc() uses up for an allocation of bytes.
+static inline unsigned long
+arena_bytes (const unsigned long bytes)
+{
+  return (bytes + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+}
+
+/* Maps an arena with room for bytes, which should be the sum of arena_bytes()
+   of everything that will be allocated from it. */
+struct arena *arena_create (const struct arena_config *config, const unsigned long bytes);
+/* Returns bytes of zeroed memory, aligned to ARENA_ALIGN, that hold grids
+   grids of rows one after the other, each of them spread over the nodes of
+   the bands; grids is 0 for memory that is not split into bands. */
+void *arena_alloc (struct arena *arena, const unsigned long bytes, const unsigned long grids);
+// Unmaps the arena and everything allocated from it.
+void arena_destroy (struct arena *arena);
+
+/* __LIFE_ARENA_H */
+#endif
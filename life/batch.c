@@ -0,0 +1,286 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Batch mode: many small worlds of the same size, stepped together. The worlds
+are bit-sliced: each cell of the grid is a lane of BATCH_WORDS words whose bit
+k belongs to world k, so one pass over the size x size grid steps BATCH_WORLDS
+worlds at once. A cell's neighbours are whole lanes, so their counts are added
+up with the same full adders as in the bit engine, only without any shifting,
+and the loop over the words of a lane is left for the compiler to vectorise
+(with AVX2 where the CPU has it).
+
+The grid has a dead border, or with --wrap a halo copied from the opposite
+edges after each step, as in the engines. Worlds are read, packed and stepped
+BATCH_WORLDS at a time, so the file is never held in memory whole.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "batch.h"
+#include "pattern.h"
+
+// Words per lane, and so worlds per pass.
+#define BATCH_WORDS 4
+#define BATCH_WORLDS (64 * BATCH_WORDS)
+
+struct batch {
+  unsigned long size;
+  // Lanes per row, including the border.
+  unsigned long stride;
+  unsigned birth;
+  unsigned survival;
+  bool wrap;
+  // (size + 2) rows of stride lanes each.
+  uint64_t *current;
+  uint64_t *next;
+  void (*step) (struct batch *batch);
+};
+
+// The lane of cell (x, y); -1 and size are the border.
+static uint64_t *
+batch_cell (const struct batch *batch, uint64_t *grid, const unsigned long x, const unsigned long y)
+{
+  return grid + ((y + 1) * batch->stride + x + 1) * BATCH_WORDS;
+}
+
+// Refreshes the halo of the current grid for --wrap.
+static void
+batch_wrap (struct batch *batch)
+{
+  const unsigned long size = batch->size;
+  const unsigned long edge = (unsigned long)-1;
+  uint64_t *grid = batch->current;
+
+  const size_t lane = BATCH_WORDS * sizeof(uint64_t);
+  for (unsigned long y = 0; y < size; y++) {
+    memcpy(batch_cell(batch, grid, edge, y), batch_cell(batch, grid, size - 1, y), lane);
+    memcpy(batch_cell(batch, grid, size, y), batch_cell(batch, grid, 0, y), lane);
+  }
+
+  const size_t row = batch->stride * lane;
+  memcpy(batch_cell(batch, grid, edge, size), batch_cell(batch, grid, edge, 0), row);
+  memcpy(batch_cell(batch, grid, edge, edge), batch_cell(batch, grid, edge, size - 1), row);
+}
+
+/* One generation of every world in the batch. Always inlined, so that each
+   of the callers below gets it compiled for its own instruction set. */
+static inline __attribute__((always_inline)) void
+batch_step_lanes (struct batch *batch)
+{
+  const unsigned long row = batch->stride * BATCH_WORDS;
+
+  for (unsigned long y = 0; y < batch->size; y++) {
+    for (unsigned long x = 0; x < batch->size; x++) {
+      // The lanes of the cell and of its eight neighbours.
+      const uint64_t *mid = batch_cell(batch, batch->current, x, y);
+      const uint64_t *up = mid - row;
+      const uint64_t *down = mid + row;
+      const uint64_t *up_left = up - BATCH_WORDS;
+      const uint64_t *up_right = up + BATCH_WORDS;
+      const uint64_t *left = mid - BATCH_WORDS;
+      const uint64_t *right = mid + BATCH_WORDS;
+      const uint64_t *down_left = down - BATCH_WORDS;
+      const uint64_t *down_right = down + BATCH_WORDS;
+      uint64_t *out = batch_cell(batch, batch->next, x, y);
+
+      for (unsigned long j = 0; j < BATCH_WORDS; j++) {
+        const uint64_t nw = up_left[j];
+        const uint64_t n = up[j];
+        const uint64_t ne = up_right[j];
+        const uint64_t wst = left[j];
+        const uint64_t c = mid[j];
+        const uint64_t est = right[j];
+        const uint64_t sw = down_left[j];
+        const uint64_t s = down[j];
+        const uint64_t se = down_right[j];
+
+        // As in bit_step_word(): a* have weight 1, b* have weight 2.
+        const uint64_t a0 = nw ^ n ^ ne;
+        const uint64_t b0 = (nw & n) | (ne & (nw ^ n));
+        const uint64_t a1 = wst ^ est ^ sw;
+        const uint64_t b1 = (wst & est) | (sw & (wst ^ est));
+        const uint64_t a2 = s ^ se;
+        const uint64_t b2 = s & se;
+
+        const uint64_t bit0 = a0 ^ a1 ^ a2;
+        const uint64_t b3 = (a0 & a1) | (a2 & (a0 ^ a1));
+        const uint64_t t = b0 ^ b1 ^ b2;
+        const uint64_t c0 = (b0 & b1) | (b2 & (b0 ^ b1));
+        const uint64_t c1 = t & b3;
+        out[j] = rule_next_planes(bit0, t ^ b3, c0 ^ c1, c0 & c1, c, batch->birth, batch->survival);
+      }
+    }
+  }
+
+  uint64_t *tmp = batch->current;
+  batch->current = batch->next;
+  batch->next = tmp;
+  if (batch->wrap)
+    batch_wrap(batch);
+}
+
+static void
+batch_step (struct batch *batch)
+{
+  batch_step_lanes(batch);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BATCH_X86
+
+__attribute__((target("avx2"))) static void
+batch_step_avx2 (struct batch *batch)
+{
+  batch_step_lanes(batch);
+}
+#endif // __x86_64__ || __i386__
+
+static void
+batch_create (struct batch *batch, const struct life_config *config)
+{
+  batch->size = config->size;
+  batch->stride = config->size + 2;
+  batch->birth = config->rule.birth;
+  batch->survival = config->rule.survival;
+  batch->wrap = config->wrap;
+  const unsigned long lanes = batch->stride * batch->stride;
+  batch->current = calloc(lanes * BATCH_WORDS, sizeof(uint64_t));
+  batch->next = calloc(lanes * BATCH_WORDS, sizeof(uint64_t));
+
+  batch->step = batch_step;
+#ifdef BATCH_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    batch->step = batch_step_avx2;
+#endif // BATCH_X86
+}
+
+/* Reads the next world from input into cells, size * size of them, and
+   returns false at the end of the file. *line counts the lines read. */
+static bool
+batch_read (FILE *input, const char *path, const unsigned long size, char *cells, char **text, size_t *capacity,
+            unsigned long *line)
+{
+  ssize_t length;
+  while ((length = getline(text, capacity, input)) >= 0) {
+    ++*line;
+    while (length > 0 && ('\n' == (*text)[length - 1] || '\r' == (*text)[length - 1]))
+      length--;
+    if (0 == length || '#' == (*text)[0])
+      continue;
+
+    // As with -i: missing cells are dead, and cells past the last are ignored.
+    const unsigned long cell_count = size * size;
+    const unsigned long given = (unsigned long)length < cell_count ? (unsigned long)length : cell_count;
+    memset(cells + given, 0, cell_count - given);
+    const unsigned long bad = scan_cells(*text, given, cells, '1', '0');
+    if (bad < given) {
+      fprintf(stderr, "Invalid character '%c' on line %lu, column %lu of %s\n", (*text)[bad], *line, bad + 1, path);
+      exit(EXIT_FAILURE);
+    }
+    return true;
+  }
+
+  if (ferror(input)) {
+    fprintf(stderr, "Could not read %s: %s\n", path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  return false;
+}
+
+void
+run_batch (const char *path, const struct life_config *config, const unsigned long generation)
+{
+  FILE *input = stdin;
+  if (0 != strcmp("-", path)) {
+    input = fopen(path, "r");
+    if (NULL == input) {
+      fprintf(stderr, "Could not open %s: %s\n", path, strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  struct batch batch;
+  batch_create(&batch, config);
+  const unsigned long size = batch.size;
+  const unsigned long cell_count = size * size;
+  const size_t grid_bytes = batch.stride * batch.stride * BATCH_WORDS * sizeof(uint64_t);
+
+  // The worlds of one batch, cell_count cells each.
+  char *cells = malloc(BATCH_WORLDS * cell_count);
+  char *text = NULL;
+  size_t capacity = 0;
+  unsigned long line = 0;
+  unsigned long index = 0;
+
+  for (;;) {
+    unsigned long worlds = 0;
+    while (worlds < BATCH_WORLDS
+           && batch_read(input, path, size, cells + worlds * cell_count, &text, &capacity, &line))
+      worlds++;
+    if (0 == worlds)
+      break;
+
+    // World k goes into bit k % 64 of word k / 64 of each lane.
+    memset(batch.current, 0, grid_bytes);
+    for (unsigned long k = 0; k < worlds; k++) {
+      const char *world = cells + k * cell_count;
+      for (unsigned long y = 0; y < size; y++) {
+        for (unsigned long x = 0; x < size; x++) {
+          const uint64_t alive = (uint64_t)(unsigned char)world[y * size + x];
+          batch_cell(&batch, batch.current, x, y)[k / 64] |= alive << (k % 64);
+        }
+      }
+    }
+    if (batch.wrap)
+      batch_wrap(&batch);
+
+    for (unsigned long g = 0; g < generation; g++)
+      batch.step(&batch);
+
+    for (unsigned long k = 0; k < worlds; k++) {
+      char *world = cells + k * cell_count;
+      unsigned long population = 0;
+      for (unsigned long y = 0; y < size; y++) {
+        for (unsigned long x = 0; x < size; x++) {
+          const uint64_t alive = (batch_cell(&batch, batch.current, x, y)[k / 64] >> (k % 64)) & 1;
+          population += alive;
+          world[y * size + x] = (char)('0' + alive);
+        }
+      }
+      printf("%lu %lu %lu ", index + k, generation, population);
+      fwrite(world, 1, cell_count, stdout);
+      putchar('\n');
+    }
+    index += worlds;
+  }
+
+  free(text);
+  free(cells);
+  free(batch.current);
+  free(batch.next);
+  if (stdin != input)
+    fclose(input);
+}
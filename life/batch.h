@@ -0,0 +1,34 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIFE_BATCH_H
+#define __LIFE_BATCH_H
+
+#include "engine.h"
+
+/* --batch: runs every world in the file at path ("-" for stdin) from
+   generation 0 to generation generation, and writes one line per world to
+   stdout. The file holds one world per line, in the form -i takes, with empty
+   lines and lines starting with # skipped. Each world is size x size, and uses
+   the rule and --wrap in config. The line written for a world is its index in
+   the file (from 0), the generation, its population and its cells as -i would
+   take them, separated by spaces. */
+void run_batch (const char *path, const struct life_config *config, const unsigned long generation);
+
+/* __LIFE_BATCH_H */
+#endif
@@ -0,0 +1,228 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+--bench: times the engines on random worlds, with nothing printed. For every
+engine, size, density and number of generations, a world of that size is
+filled at random with live cells in that proportion and advanced by that many
+generations: first --bench-warmup times untimed, then --bench-repeat times
+timed. Only advancing is timed, not creating and filling the world, and every
+run starts from the same world, so the runs of an engine are alike and every
+engine gets the same worlds.
+
+Each combination gives one JSON object (or CSV line): the mean, standard
+deviation and minimum of the timed runs, the throughput in cells per second
+and nanoseconds per cell that the mean works out at, and the peak resident
+set size of the process while the combination ran. Linux resets the peak when
+5 is written to /proc/self/clear_refs; where that does not work, the peak is
+that of the whole process so far.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <math.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "bench.h"
+
+double *
+parse_densities (const char *list, unsigned long *count)
+{
+  double *densities = NULL;
+  *count = 0;
+
+  const char *cursor = list;
+  while (true) {
+    char *end = NULL;
+    const double density = strtod(cursor, &end);
+    if (end == cursor || (',' != *end && '\0' != *end) || density < 0 || density > 1) {
+      fprintf(stderr, "Invalid list of densities: %s\n", list);
+      exit(EXIT_FAILURE);
+    }
+    densities = realloc(densities, (*count + 1) * sizeof(double));
+    densities[(*count)++] = density;
+    if ('\0' == *end)
+      break;
+    cursor = end + 1;
+  }
+  return densities;
+}
+
+static double
+bench_now (void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+static void
+bench_reset_peak (void)
+{
+#ifdef __GLIBC__
+  // Hand memory freed by earlier combinations back, or it still counts as resident.
+  malloc_trim(0);
+#endif
+  FILE *file = fopen("/proc/self/clear_refs", "w");
+  if (NULL == file)
+    return;
+  fputs("5", file);
+  fclose(file);
+}
+
+// Peak resident set size in KiB, since bench_reset_peak() if it worked.
+static unsigned long
+bench_peak (void)
+{
+  FILE *file = fopen("/proc/self/status", "r");
+  if (NULL != file) {
+    char line[256];
+    unsigned long peak = 0;
+    while (NULL != fgets(line, sizeof(line), file)) {
+      if (1 == sscanf(line, "VmHWM: %lu kB", &peak))
+        break;
+    }
+    fclose(file);
+    if (peak > 0)
+      return peak;
+  }
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (unsigned long)usage.ru_maxrss;
+}
+
+// The same random world for the same size and density, whichever engine it is for.
+static void
+bench_fill (const struct engine *engine, void *world, const unsigned long size, const double density, char *row)
+{
+  uint64_t state = 0x9e3779b97f4a7c15ULL ^ (size * 0x2545f4914f6cdd1dULL) ^ (uint64_t)(density * 1e9);
+  const uint64_t threshold = (uint64_t)(density * 18446744073709551615.0);
+  for (unsigned long y = 0; y < size; y++) {
+    for (unsigned long x = 0; x < size; x++) {
+      // xorshift64*
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      row[x] = (char)(state * 0x2545f4914f6cdd1dULL < threshold);
+    }
+    engine->load_row(world, y, row);
+  }
+}
+
+// Seconds taken to advance a fresh random world by generations.
+static double
+bench_run (const struct bench_config *config, const struct engine *engine, struct pool *pool,
+           const unsigned long size, const double density, const unsigned long generations)
+{
+  struct life_config life = config->life;
+  life.size = size;
+  void *world = engine->create(&life);
+  char *row = malloc(size);
+  bench_fill(engine, world, size, density, row);
+
+  const double start = bench_now();
+  advance_world(engine, world, size, pool, generations);
+  const double seconds = bench_now() - start;
+
+  engine->destroy(world);
+  free(row);
+  return seconds;
+}
+
+static void
+bench_combination (const struct bench_config *config, const struct engine *engine, const unsigned long size,
+                   const double density, const unsigned long generations, const bool first)
+{
+  struct pool *pool = NULL != engine->step_rows ? config->pool : NULL;
+  const unsigned long threads = NULL != pool ? pool_threads(pool) : 1;
+
+  bench_reset_peak();
+  for (unsigned long i = 0; i < config->warmup; i++)
+    bench_run(config, engine, pool, size, density, generations);
+
+  double sum = 0;
+  double squares = 0;
+  double minimum = INFINITY;
+  for (unsigned long i = 0; i < config->repetitions; i++) {
+    const double seconds = bench_run(config, engine, pool, size, density, generations);
+    sum += seconds;
+    squares += seconds * seconds;
+    if (seconds < minimum)
+      minimum = seconds;
+  }
+  const unsigned long peak = bench_peak();
+
+  const double n = (double)config->repetitions;
+  const double mean = sum / n;
+  const double variance = n > 1 ? (squares - sum * sum / n) / (n - 1) : 0;
+  const double stddev = variance > 0 ? sqrt(variance) : 0;
+  const double cells = (double)size * (double)size * (double)generations;
+  const double rate = mean > 0 ? cells / mean : 0;
+  const double ns = cells > 0 ? mean * 1e9 / cells : 0;
+
+  if (config->csv) {
+    printf("%s,%lu,%g,%lu,%lu,%lu,%.9f,%.9f,%.9f,%.6g,%.6g,%lu\n", engine->name, size, density, generations, threads,
+           config->repetitions, mean, stddev, minimum, rate, ns, peak);
+  } else {
+    printf("%s  {\"engine\": \"%s\", \"size\": %lu, \"density\": %g, \"generations\": %lu, \"threads\": %lu, "
+           "\"repetitions\": %lu, \"mean_s\": %.9f, \"stddev_s\": %.9f, \"min_s\": %.9f, "
+           "\"cells_per_s\": %.6g, \"ns_per_cell\": %.6g, \"peak_rss_kib\": %lu}",
+           first ? "" : ",\n", engine->name, size, density, generations, threads, config->repetitions, mean, stddev,
+           minimum, rate, ns, peak);
+  }
+  fflush(stdout);
+}
+
+void
+run_bench (const struct bench_config *config)
+{
+  if (config->csv)
+    printf("engine,size,density,generations,threads,repetitions,mean_s,stddev_s,min_s,cells_per_s,ns_per_cell,"
+           "peak_rss_kib\n");
+  else
+    printf("[\n");
+
+  bool first = true;
+  for (unsigned long e = 0; e < engine_count; e++) {
+    const struct engine *engine = engines[e];
+    if (NULL != config->engine && config->engine != engine)
+      continue;
+    // As in main(): B0 rules and --wrap cannot run on an unbounded plane.
+    if (((config->life.rule.birth & 1) || config->life.wrap) && engine->unbounded)
+      continue;
+    for (unsigned long s = 0; s < config->size_count; s++) {
+      for (unsigned long d = 0; d < config->density_count; d++) {
+        for (unsigned long g = 0; g < config->generation_count; g++) {
+          bench_combination(config, engine, config->sizes[s], config->densities[d], config->generations[g], first);
+          first = false;
+        }
+      }
+    }
+  }
+
+  if (!config->csv)
+    printf("\n]\n");
+}
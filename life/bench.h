@@ -0,0 +1,56 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIFE_BENCH_H
+#define __LIFE_BENCH_H
+
+#include <stdbool.h>
+
+#include "engine.h"
+#include "pool.h"
+
+// What --bench runs: every combination of the engines, sizes, densities and generations.
+struct bench_config {
+  // The engine given with -e, or NULL for all of them.
+  const struct engine *engine;
+  const unsigned long *sizes;
+  unsigned long size_count;
+  const double *densities;
+  unsigned long density_count;
+  const unsigned long *generations;
+  unsigned long generation_count;
+  // Timed runs of each combination, after warmup runs that are not timed.
+  unsigned long repetitions;
+  unsigned long warmup;
+  // CSV rather than JSON.
+  bool csv;
+  // Used by the engines that can run on several threads; may be NULL.
+  struct pool *pool;
+  // Everything but the size is passed on to the engines as is.
+  struct life_config life;
+};
+
+/* Parses a comma-separated list of densities, each in [0, 1], into an array
+   of count of them. */
+double *parse_densities (const char *list, unsigned long *count);
+
+// Runs the benchmark and writes one record per combination to stdout.
+void run_bench (const struct bench_config *config);
+
+/* __LIFE_BENCH_H */
+#endif
@@ -0,0 +1,324 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Bit-packed engine: each row is stored as 64 cells per uint64_t word (cell x
+is bit x % 64 of word x / 64), and the next generation is computed for a whole
+word at a time by adding up the eight neighbour bit-planes with full adders.
+
+Every row is surrounded by a dead word on each side and the grid by a dead row
+above and below, so the kernel never tests for the edge of the world. Bits past
+the last cell of a row are kept at 0 for the same reason. With --wrap, the bit
+just west of each row (the top bit of its left word) and the one just east of
+it (in the last word, or the right word) hold the cells at the far end of the
+row instead, and the rows above and below are copies of the bottom and top
+rows; bit_wrap_row() refreshes them after every step.
+
+The adders give each cell's count as four bit-planes, and the rule is applied
+to them by decoding the count and keeping the counts the rule lets live. Any
+rule works that way, but with the rule known at compile time the compiler
+keeps only the terms it needs, so there is a kernel compiled for each of a few
+well-known rules (Conway's among them), and a generic one for the rest.
+
+For --stats, each row of the next generation is counted as soon as it has
+been computed, with a popcount of every word, of its bits that were clear in
+the current generation (births) and of the bits it cleared (deaths).
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+#include "stats.h"
+
+typedef void (*bit_row_fn) (const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *out,
+                            const unsigned long words, const struct rule *rule);
+
+struct bit_world {
+  unsigned long size;
+  struct rule rule;
+  bit_row_fn step_row;
+  // Words holding cells in each row.
+  unsigned long words;
+  // Words per row including the two dead border words.
+  unsigned long stride;
+  // Valid bits of the last word in each row.
+  uint64_t tail_mask;
+  bool wrap;
+  // Holds every grid below.
+  struct arena *arena;
+  // (size + 2) rows of stride words each.
+  uint64_t *current;
+  uint64_t *next;
+  // For --stats, the numbers of each row of the last step; NULL without.
+  struct row_stats *row_stats;
+};
+
+static uint64_t *
+bit_row (const struct bit_world *world, uint64_t *grid, const unsigned long y)
+{
+  // row -1 and row size are the dead border.
+  return grid + (y + 1) * world->stride + 1;
+}
+
+/* Computes the next state of the 64 cells in word w of row mid under the rule
+   with the given birth and survival masks. up and down are the rows above and
+   below. Always inlined, so that a constant rule is folded into the code. */
+static inline __attribute__((always_inline)) uint64_t
+bit_step_word (const uint64_t *up, const uint64_t *mid, const uint64_t *down, const unsigned long w,
+               const unsigned birth, const unsigned survival)
+{
+  // Shifting left moves each cell's west neighbour into its bit position.
+  const uint64_t n = up[w];
+  const uint64_t nw = (up[w] << 1) | (up[w - 1] >> 63);
+  const uint64_t ne = (up[w] >> 1) | (up[w + 1] << 63);
+  const uint64_t c = mid[w];
+  const uint64_t wst = (mid[w] << 1) | (mid[w - 1] >> 63);
+  const uint64_t est = (mid[w] >> 1) | (mid[w + 1] << 63);
+  const uint64_t s = down[w];
+  const uint64_t sw = (down[w] << 1) | (down[w - 1] >> 63);
+  const uint64_t se = (down[w] >> 1) | (down[w + 1] << 63);
+
+  // Three rows of full/half adders: a* have weight 1, b* have weight 2.
+  const uint64_t a0 = nw ^ n ^ ne;
+  const uint64_t b0 = (nw & n) | (ne & (nw ^ n));
+  const uint64_t a1 = wst ^ est ^ sw;
+  const uint64_t b1 = (wst & est) | (sw & (wst ^ est));
+  const uint64_t a2 = s ^ se;
+  const uint64_t b2 = s & se;
+
+  // Sum the weight 1 bits into bit 0 of the count, carrying into b3.
+  const uint64_t bit0 = a0 ^ a1 ^ a2;
+  const uint64_t b3 = (a0 & a1) | (a2 & (a0 ^ a1));
+
+  // Sum the four weight 2 bits into bit 1 of the count, carrying weight 4.
+  const uint64_t t = b0 ^ b1 ^ b2;
+  const uint64_t c0 = (b0 & b1) | (b2 & (b0 ^ b1));
+  const uint64_t bit1 = t ^ b3;
+  const uint64_t c1 = t & b3;
+
+  // One weight 4 carry is a count of 4 to 7; both of them make 8.
+  return rule_next_planes(bit0, bit1, c0 ^ c1, c0 & c1, c, birth, survival);
+}
+
+// A row kernel with the rule birth/survival compiled in.
+#define BIT_ROW_KERNEL(name, birth, survival)                                                                  \
+  static void name (const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *out,               \
+                    const unsigned long words, const struct rule *rule)                                        \
+  {                                                                                                            \
+    (void)rule;                                                                                                \
+    for (unsigned long w = 0; w < words; w++)                                                                  \
+      out[w] = bit_step_word(up, mid, down, w, birth, survival);                                               \
+  }
+
+BIT_ROW_KERNEL(bit_row_conway, 0x008, 0x00c)     // B3/S23
+BIT_ROW_KERNEL(bit_row_highlife, 0x048, 0x00c)   // B36/S23
+BIT_ROW_KERNEL(bit_row_day_night, 0x1c8, 0x1d8)  // B3678/S34678
+BIT_ROW_KERNEL(bit_row_seeds, 0x004, 0x000)      // B2/S
+
+static void
+bit_row_generic (const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *out,
+                 const unsigned long words, const struct rule *rule)
+{
+  for (unsigned long w = 0; w < words; w++)
+    out[w] = bit_step_word(up, mid, down, w, rule->birth, rule->survival);
+}
+
+static const struct {
+  struct rule rule;
+  bit_row_fn step_row;
+} bit_kernels[] = {
+  { { 0x008, 0x00c }, bit_row_conway },
+  { { 0x048, 0x00c }, bit_row_highlife },
+  { { 0x1c8, 0x1d8 }, bit_row_day_night },
+  { { 0x004, 0x000 }, bit_row_seeds },
+};
+
+/* The eight cells that each byte of a row stands for, so that read_row()
+   expands a byte at a time; checkpoints and output read whole worlds. */
+static char bit_spread[256][8];
+
+static void *
+bit_create (const struct life_config *config)
+{
+  struct bit_world *world = malloc(sizeof(*world));
+  world->size = config->size;
+  world->rule = config->rule;
+  world->step_row = bit_row_generic;
+  for (unsigned long i = 0; i < sizeof(bit_kernels) / sizeof(bit_kernels[0]); i++) {
+    if (rule_equal(&bit_kernels[i].rule, &config->rule))
+      world->step_row = bit_kernels[i].step_row;
+  }
+  world->wrap = config->wrap;
+  world->words = (config->size + 63) / 64;
+  world->stride = world->words + 2;
+  world->tail_mask = ~(uint64_t)0;
+  if (0 != config->size % 64)
+    world->tail_mask = ((uint64_t)1 << (config->size % 64)) - 1;
+
+  for (int byte = 0; byte < 256; byte++) {
+    for (int bit = 0; bit < 8; bit++)
+      bit_spread[byte][bit] = (char)((byte >> bit) & 1);
+  }
+
+  const unsigned long grid = world->stride * (config->size + 2) * sizeof(uint64_t);
+  world->arena = arena_create(&config->arena, 2 * arena_bytes(grid));
+  world->current = arena_alloc(world->arena, grid, 1);
+  world->next = arena_alloc(world->arena, grid, 1);
+  world->row_stats = config->stats ? malloc(config->size * sizeof(struct row_stats)) : NULL;
+  return world;
+}
+
+// Refreshes the halo around row y of grid for --wrap.
+static void
+bit_wrap_row (const struct bit_world *world, uint64_t *grid, const unsigned long y)
+{
+  const unsigned long size = world->size;
+  uint64_t *cells = bit_row(world, grid, y);
+  cells[-1] = ((cells[(size - 1) / 64] >> ((size - 1) % 64)) & 1) << 63;
+  const uint64_t east = (uint64_t)1 << (size % 64);
+  cells[size / 64] = (cells[size / 64] & ~east) | ((cells[0] & 1) << (size % 64));
+
+  const unsigned long bytes = world->stride * sizeof(uint64_t);
+  if (0 == y)
+    memcpy(bit_row(world, grid, size) - 1, cells - 1, bytes);
+  if (size - 1 == y)
+    memcpy(bit_row(world, grid, (unsigned long)-1) - 1, cells - 1, bytes);
+}
+
+static void
+bit_load_row (void *state, const unsigned long y, const char *row)
+{
+  struct bit_world *world = state;
+  uint64_t *cells = bit_row(world, world->current, y);
+  memset(cells, 0, world->words * sizeof(uint64_t));
+  // Without a branch per cell, since loaded patterns are often noisy.
+  for (unsigned long x = 0; x < world->size; x++)
+    cells[x / 64] |= (uint64_t)(unsigned char)row[x] << (x % 64);
+  if (world->wrap)
+    bit_wrap_row(world, world->current, y);
+}
+
+static void
+bit_read_row (const void *state, const unsigned long y, char *row)
+{
+  const struct bit_world *world = state;
+  const uint64_t *cells = bit_row(world, world->current, y);
+  unsigned long x = 0;
+  for (; x + 8 <= world->size; x += 8)
+    memcpy(row + x, bit_spread[(cells[x / 64] >> (x % 64)) & 0xff], 8);
+  for (; x < world->size; x++)
+    row[x] = (char)((cells[x / 64] >> (x % 64)) & 1);
+}
+
+// Counts row out of the next generation against row mid of the current one.
+static void
+bit_count_row (const struct bit_world *world, const uint64_t *mid, const uint64_t *out, struct row_stats *stats)
+{
+  unsigned long population = 0;
+  unsigned long births = 0;
+  unsigned long deaths = 0;
+  for (unsigned long w = 0; w < world->words; w++) {
+    // With --wrap, the last word of mid may hold the halo cell east of the row.
+    const uint64_t before = w + 1 < world->words ? mid[w] : mid[w] & world->tail_mask;
+    population += (unsigned long)__builtin_popcountll(out[w]);
+    births += (unsigned long)__builtin_popcountll(out[w] & ~before);
+    deaths += (unsigned long)__builtin_popcountll(before & ~out[w]);
+  }
+  stats->population = population;
+  stats->births = births;
+  stats->deaths = deaths;
+  if (0 == population)
+    return;
+
+  unsigned long first = 0;
+  while (0 == out[first])
+    first++;
+  unsigned long last = world->words - 1;
+  while (0 == out[last])
+    last--;
+  stats->first = first * 64 + (unsigned long)__builtin_ctzll(out[first]);
+  stats->last = last * 64 + 63 - (unsigned long)__builtin_clzll(out[last]);
+}
+
+static void
+bit_step_rows (void *state, const unsigned long begin, const unsigned long end)
+{
+  struct bit_world *world = state;
+
+  for (unsigned long y = begin; y < end; y++) {
+    const uint64_t *up = bit_row(world, world->current, y - 1);
+    const uint64_t *mid = bit_row(world, world->current, y);
+    const uint64_t *down = bit_row(world, world->current, y + 1);
+    uint64_t *out = bit_row(world, world->next, y);
+
+    world->step_row(up, mid, down, out, world->words, &world->rule);
+    out[world->words - 1] &= world->tail_mask;
+    if (NULL != world->row_stats)
+      bit_count_row(world, mid, out, &world->row_stats[y]);
+  }
+}
+
+static void
+bit_commit (void *state)
+{
+  struct bit_world *world = state;
+  uint64_t *tmp = world->current;
+  world->current = world->next;
+  world->next = tmp;
+  if (world->wrap) {
+    for (unsigned long y = 0; y < world->size; y++)
+      bit_wrap_row(world, world->current, y);
+  }
+}
+
+static void
+bit_step (void *state)
+{
+  struct bit_world *world = state;
+  bit_step_rows(world, 0, world->size);
+  bit_commit(world);
+}
+
+static void
+bit_stats (const void *state, struct life_stats *stats)
+{
+  const struct bit_world *world = state;
+  sum_row_stats(world->row_stats, world->size, stats);
+}
+
+static void
+bit_destroy (void *state)
+{
+  struct bit_world *world = state;
+  free(world->row_stats);
+  arena_destroy(world->arena);
+  free(world);
+}
+
+const struct engine bit_engine = {
+  .name = "bit",
+  .create = bit_create,
+  .load_row = bit_load_row,
+  .read_row = bit_read_row,
+  .step = bit_step,
+  .step_rows = bit_step_rows,
+  .commit = bit_commit,
+  .stats = bit_stats,
+  .destroy = bit_destroy,
+};
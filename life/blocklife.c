@@ -0,0 +1,231 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Temporally blocked engine: rather than streaming the whole world through
+memory once per generation, advance() takes one BLOCK_TILE x BLOCK_TILE tile
+at a time and moves it k generations on (k is --block-depth) while it sits in
+cache.
+
+A tile's next k generations depend on the cells up to k away from it, so the
+tile is copied out together with a ghost zone k cells wide into a small
+scratch square. Each generation computed there is one cell smaller on every
+side than the last (a trapezoid in space-time), and after k of them exactly the
+tile is left. It goes back into the other world buffer. Ghost cells are
+recomputed by each tile that needs them, which costs some work but keeps the
+tiles independent. Only every k-th generation is written to the world buffers.
+
+Cells outside the world are kept dead in every generation, so the results are
+the same as the byte engine's. With --wrap, the ghost zone is filled from the
+opposite edges instead, and nothing is outside the world.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+
+// Tile edge, in cells; with the default depth two scratch squares fit in L2.
+#define BLOCK_TILE 128
+
+struct block_world {
+  unsigned long size;
+  unsigned long depth;
+  // Bytes per row; cell (x, y) is at (y + 1) * stride + x + 1.
+  unsigned long stride;
+  uint32_t rule;
+  bool wrap;
+  // Holds every grid below.
+  struct arena *arena;
+  char *current;
+  char *next;
+  // Two squares of (BLOCK_TILE + 2 * depth) cells on a side.
+  char *scratch[2];
+};
+
+static void *
+block_create (const struct life_config *config)
+{
+  struct block_world *world = malloc(sizeof(*world));
+  world->size = config->size;
+  world->depth = config->block_depth;
+  world->stride = config->size + 2;
+  world->rule = rule_mask(&config->rule);
+  world->wrap = config->wrap;
+  const unsigned long grid = world->stride * world->stride;
+  const unsigned long side = BLOCK_TILE + 2 * world->depth;
+  world->arena = arena_create(&config->arena, 2 * arena_bytes(grid) + 2 * arena_bytes(side * side));
+  world->current = arena_alloc(world->arena, grid, 1);
+  world->next = arena_alloc(world->arena, grid, 1);
+  world->scratch[0] = arena_alloc(world->arena, side * side, 0);
+  world->scratch[1] = arena_alloc(world->arena, side * side, 0);
+  return world;
+}
+
+static void
+block_load_row (void *state, const unsigned long y, const char *row)
+{
+  struct block_world *world = state;
+  memcpy(world->current + (y + 1) * world->stride + 1, row, world->size);
+}
+
+static void
+block_read_row (const void *state, const unsigned long y, char *row)
+{
+  const struct block_world *world = state;
+  memcpy(row, world->current + (y + 1) * world->stride + 1, world->size);
+}
+
+/* Copies side cells of world row y, starting at column x and wrapping around
+   the edges of the world, into out. */
+static void
+block_copy_wrapped (const struct block_world *world, char *out, const long x, const long y, const long side)
+{
+  const long size = (long)world->size;
+  const char *row = world->current + ((y % size + size) % size + 1) * (long)world->stride + 1;
+  long from = (x % size + size) % size;
+  for (long done = 0; done < side;) {
+    const long run = size - from < side - done ? size - from : side - done;
+    memcpy(out + done, row + from, (size_t)run);
+    done += run;
+    from = 0;
+  }
+}
+
+/* Advances the tile whose top-left cell is (x0, y0) by depth generations, from
+   world->current into world->next. Scratch cell (sx, sy) is world cell
+   (x0 - depth + sx, y0 - depth + sy). */
+static void
+block_step_tile (struct block_world *world, const long x0, const long y0, const long depth)
+{
+  const long size = (long)world->size;
+  const long side = BLOCK_TILE + 2 * depth;
+  const long left = x0 - depth;
+  const long top = y0 - depth;
+
+  // Scratch columns [lo, hi) are inside the world; the rest stay dead.
+  const long lo = world->wrap || left >= 0 ? 0 : -left;
+  const long hi = world->wrap || left + side <= size ? side : size - left;
+
+  char *src = world->scratch[0];
+  for (long sy = 0; sy < side; sy++) {
+    char *out = src + sy * side;
+    if (world->wrap) {
+      block_copy_wrapped(world, out, left, top + sy, side);
+      continue;
+    }
+    memset(out, 0, (size_t)side);
+    if (top + sy >= 0 && top + sy < size && lo < hi)
+      memcpy(out + lo, world->current + (top + sy + 1) * (long)world->stride + 1 + left + lo, (size_t)(hi - lo));
+  }
+
+  char *dst = world->scratch[1];
+  for (long g = 1; g <= depth; g++) {
+    // This generation is valid on scratch rows and columns [g, side - g).
+    const long first = lo > g ? lo : g;
+    const long last = hi < side - g ? hi : side - g;
+
+    for (long sy = g; sy < side - g; sy++) {
+      char *out = dst + sy * side;
+      if ((!world->wrap && (top + sy < 0 || top + sy >= size)) || first >= last) {
+        memset(out + g, 0, (size_t)(side - 2 * g));
+        continue;
+      }
+
+      const char *up = src + (sy - 1) * side;
+      const char *mid = up + side;
+      const char *down = mid + side;
+      int west = up[first - 1] + mid[first - 1] + down[first - 1];
+      int centre = up[first] + mid[first] + down[first];
+      for (long sx = first; sx < last; sx++) {
+        const int east = up[sx + 1] + mid[sx + 1] + down[sx + 1];
+        const int ln = west + centre + east - mid[sx];
+        out[sx] = rule_next(world->rule, mid[sx], ln);
+        west = centre;
+        centre = east;
+      }
+      if (first > g)
+        memset(out + g, 0, (size_t)(first - g));
+      if (last < side - g)
+        memset(out + last, 0, (size_t)(side - g - last));
+    }
+
+    char *tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+
+  // What is left is exactly the tile, clipped to the world.
+  const long width = x0 + BLOCK_TILE > size ? size - x0 : BLOCK_TILE;
+  const long height = y0 + BLOCK_TILE > size ? size - y0 : BLOCK_TILE;
+  for (long y = 0; y < height; y++)
+    memcpy(world->next + (y0 + y + 1) * (long)world->stride + x0 + 1, src + (depth + y) * side + depth,
+           (size_t)width);
+}
+
+// Advances every tile by depth generations.
+static void
+block_pass (struct block_world *world, const unsigned long depth)
+{
+  for (unsigned long y0 = 0; y0 < world->size; y0 += BLOCK_TILE) {
+    for (unsigned long x0 = 0; x0 < world->size; x0 += BLOCK_TILE)
+      block_step_tile(world, (long)x0, (long)y0, (long)depth);
+  }
+
+  char *tmp = world->current;
+  world->current = world->next;
+  world->next = tmp;
+}
+
+static void
+block_advance (void *state, const unsigned long generations)
+{
+  struct block_world *world = state;
+  unsigned long left = generations;
+  while (left >= world->depth) {
+    block_pass(world, world->depth);
+    left -= world->depth;
+  }
+  if (left > 0)
+    block_pass(world, left);
+}
+
+static void
+block_step (void *state)
+{
+  block_pass(state, 1);
+}
+
+static void
+block_destroy (void *state)
+{
+  struct block_world *world = state;
+  arena_destroy(world->arena);
+  free(world);
+}
+
+const struct engine block_engine = {
+  .name = "blocked",
+  .create = block_create,
+  .load_row = block_load_row,
+  .read_row = block_read_row,
+  .step = block_step,
+  .advance = block_advance,
+  .destroy = block_destroy,
+};
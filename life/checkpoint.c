@@ -0,0 +1,303 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Checkpoints: the world is copied into a bit-packed image of the whole file
+between steps, which is the only part that holds up the run, and a writer
+thread writes the image out while the run goes on. There are two images, so
+the next checkpoint can be packed while the last one is still being written;
+only a checkpoint that comes round before the last has been written waits.
+
+The writer writes to path.tmp, fsync()s it and renames it over path, so a
+crash at any point leaves either the old checkpoint or the new one. It then
+fsync()s the directory too, as the rename is only on disk once that is.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+#include "pattern.h"
+
+#define CHECKPOINT_MAGIC "LIFECKP1"
+#define CHECKPOINT_HEADER 32UL
+#define CHECKPOINT_WRAP 1U
+
+struct checkpoint {
+  const char *path;
+  // Where a checkpoint is written before it is renamed to path.
+  char *temporary;
+  // The directory path is in, to fsync() after the rename.
+  char *directory;
+  unsigned long size;
+  struct rule rule;
+  bool wrap;
+  // Bytes per packed row, and in a whole image.
+  unsigned long row_bytes;
+  unsigned long length;
+  // A row as read_row() gives it.
+  char *row;
+  // checkpoint_save() packs into images[filling] while the other may be being written.
+  unsigned char *images[2];
+  int filling;
+
+  pthread_t writer;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  // The image being written or waiting to be, if any.
+  const unsigned char *pending;
+  // Set to have the writer exit once pending is written.
+  bool stop;
+};
+
+static void
+checkpoint_put (unsigned char *out, uint64_t value, const int bytes)
+{
+  for (int i = 0; i < bytes; i++) {
+    out[i] = (unsigned char)value;
+    value >>= 8;
+  }
+}
+
+static uint64_t
+checkpoint_get (const unsigned char *in, const int bytes)
+{
+  uint64_t value = 0;
+  for (int i = bytes - 1; i >= 0; i--)
+    value = value << 8 | in[i];
+  return value;
+}
+
+// Writes image out to checkpoint->temporary, then renames it to checkpoint->path.
+static void
+checkpoint_write (const struct checkpoint *checkpoint, const unsigned char *image)
+{
+  const int fd = open(checkpoint->temporary, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    fprintf(stderr, "Could not create %s: %s\n", checkpoint->temporary, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  unsigned long written = 0;
+  while (written < checkpoint->length) {
+    const ssize_t done = write(fd, image + written, checkpoint->length - written);
+    if (done < 0 && EINTR == errno)
+      continue;
+    if (done < 0) {
+      fprintf(stderr, "Could not write %s: %s\n", checkpoint->temporary, strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+    written += (unsigned long)done;
+  }
+
+  if (0 != fsync(fd) || 0 != close(fd)) {
+    fprintf(stderr, "Could not write %s: %s\n", checkpoint->temporary, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  if (0 != rename(checkpoint->temporary, checkpoint->path)) {
+    fprintf(stderr, "Could not rename %s to %s: %s\n", checkpoint->temporary, checkpoint->path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  const int directory = open(checkpoint->directory, O_RDONLY | O_DIRECTORY);
+  if (directory < 0 || 0 != fsync(directory) || 0 != close(directory)) {
+    fprintf(stderr, "Could not sync %s: %s\n", checkpoint->directory, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+}
+
+static void *
+checkpoint_writer (void *data)
+{
+  struct checkpoint *checkpoint = data;
+
+  pthread_mutex_lock(&checkpoint->lock);
+  while (true) {
+    while (NULL == checkpoint->pending && !checkpoint->stop)
+      pthread_cond_wait(&checkpoint->changed, &checkpoint->lock);
+    if (NULL == checkpoint->pending)
+      break;
+
+    // pending stays set while it is written, so that it is not packed over.
+    pthread_mutex_unlock(&checkpoint->lock);
+    checkpoint_write(checkpoint, checkpoint->pending);
+    pthread_mutex_lock(&checkpoint->lock);
+    checkpoint->pending = NULL;
+    pthread_cond_broadcast(&checkpoint->changed);
+  }
+  pthread_mutex_unlock(&checkpoint->lock);
+  return NULL;
+}
+
+struct checkpoint *
+checkpoint_create (const char *path, const struct life_config *config)
+{
+  struct checkpoint *checkpoint = malloc(sizeof(*checkpoint));
+  checkpoint->path = path;
+  checkpoint->temporary = malloc(strlen(path) + sizeof(".tmp"));
+  strcpy(checkpoint->temporary, path);
+  strcat(checkpoint->temporary, ".tmp");
+  const char *slash = strrchr(path, '/');
+  if (NULL == slash) {
+    checkpoint->directory = strdup(".");
+  } else {
+    // Up to the last slash, but keeping the one of "/" itself.
+    const size_t length = slash == path ? 1 : (size_t)(slash - path);
+    checkpoint->directory = strndup(path, length);
+  }
+
+  checkpoint->size = config->size;
+  checkpoint->rule = config->rule;
+  checkpoint->wrap = config->wrap;
+  checkpoint->row_bytes = (config->size + 7) / 8;
+  checkpoint->length = CHECKPOINT_HEADER + config->size * checkpoint->row_bytes;
+  checkpoint->row = malloc(config->size);
+  checkpoint->images[0] = malloc(checkpoint->length);
+  checkpoint->images[1] = malloc(checkpoint->length);
+  checkpoint->filling = 0;
+
+  checkpoint->pending = NULL;
+  checkpoint->stop = false;
+  pthread_mutex_init(&checkpoint->lock, NULL);
+  pthread_cond_init(&checkpoint->changed, NULL);
+  if (0 != pthread_create(&checkpoint->writer, NULL, checkpoint_writer, checkpoint)) {
+    fprintf(stderr, "Could not start the checkpoint writer\n");
+    exit(EXIT_FAILURE);
+  }
+  return checkpoint;
+}
+
+void
+checkpoint_save (struct checkpoint *checkpoint, const struct engine *engine, const void *world,
+                 const unsigned long generation)
+{
+  unsigned char *image = checkpoint->images[checkpoint->filling];
+  memcpy(image, CHECKPOINT_MAGIC, 8);
+  checkpoint_put(image + 8, checkpoint->size, 8);
+  checkpoint_put(image + 16, generation, 8);
+  checkpoint_put(image + 24, checkpoint->rule.birth, 2);
+  checkpoint_put(image + 26, checkpoint->rule.survival, 2);
+  checkpoint_put(image + 28, checkpoint->wrap ? CHECKPOINT_WRAP : 0, 4);
+  for (unsigned long y = 0; y < checkpoint->size; y++) {
+    engine->read_row(world, y, checkpoint->row);
+    pack_cells(checkpoint->row, checkpoint->size, image + CHECKPOINT_HEADER + y * checkpoint->row_bytes);
+  }
+
+  pthread_mutex_lock(&checkpoint->lock);
+  while (NULL != checkpoint->pending)
+    pthread_cond_wait(&checkpoint->changed, &checkpoint->lock);
+  checkpoint->pending = image;
+  pthread_cond_broadcast(&checkpoint->changed);
+  pthread_mutex_unlock(&checkpoint->lock);
+  checkpoint->filling = 1 - checkpoint->filling;
+}
+
+void
+checkpoint_destroy (struct checkpoint *checkpoint)
+{
+  pthread_mutex_lock(&checkpoint->lock);
+  checkpoint->stop = true;
+  pthread_cond_broadcast(&checkpoint->changed);
+  pthread_mutex_unlock(&checkpoint->lock);
+  pthread_join(checkpoint->writer, NULL);
+
+  pthread_mutex_destroy(&checkpoint->lock);
+  pthread_cond_destroy(&checkpoint->changed);
+  free(checkpoint->temporary);
+  free(checkpoint->directory);
+  free(checkpoint->row);
+  free(checkpoint->images[0]);
+  free(checkpoint->images[1]);
+  free(checkpoint);
+}
+
+// Opens the checkpoint at path and reads its header, checking that the file is whole.
+static FILE *
+checkpoint_open (const char *path, struct checkpoint_header *header)
+{
+  FILE *file = fopen(path, "rb");
+  if (NULL == file) {
+    fprintf(stderr, "Could not open %s: %s\n", path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  unsigned char bytes[CHECKPOINT_HEADER];
+  if (1 != fread(bytes, sizeof(bytes), 1, file) || 0 != memcmp(bytes, CHECKPOINT_MAGIC, 8)) {
+    fprintf(stderr, "%s is not a checkpoint\n", path);
+    exit(EXIT_FAILURE);
+  }
+  header->size = (unsigned long)checkpoint_get(bytes + 8, 8);
+  header->generation = (unsigned long)checkpoint_get(bytes + 16, 8);
+  header->rule.birth = (uint16_t)checkpoint_get(bytes + 24, 2);
+  header->rule.survival = (uint16_t)checkpoint_get(bytes + 26, 2);
+  header->wrap = 0 != (checkpoint_get(bytes + 28, 4) & CHECKPOINT_WRAP);
+
+  /* The size comes from the file: one whose image would not fit in an
+     unsigned long could otherwise wrap around to the length of the file. */
+  const unsigned long row_bytes = header->size / 8 + (0 != header->size % 8);
+  if (0 == row_bytes || header->size > (ULONG_MAX - CHECKPOINT_HEADER) / row_bytes) {
+    fprintf(stderr, "%s is not a checkpoint: a size of %lu is out of range\n", path, header->size);
+    exit(EXIT_FAILURE);
+  }
+
+  struct stat status;
+  const unsigned long length = CHECKPOINT_HEADER + header->size * row_bytes;
+  if (0 != fstat(fileno(file), &status) || (unsigned long)status.st_size != length) {
+    fprintf(stderr, "%s is not a whole checkpoint of a %lu x %lu world\n", path, header->size, header->size);
+    exit(EXIT_FAILURE);
+  }
+  return file;
+}
+
+void
+checkpoint_read_header (const char *path, struct checkpoint_header *header)
+{
+  fclose(checkpoint_open(path, header));
+}
+
+void
+checkpoint_load (const char *path, const struct engine *engine, void *world)
+{
+  struct checkpoint_header header;
+  FILE *file = checkpoint_open(path, &header);
+
+  const unsigned long row_bytes = (header.size + 7) / 8;
+  unsigned char *packed = malloc(row_bytes);
+  char *row = malloc(header.size);
+  for (unsigned long y = 0; y < header.size; y++) {
+    if (1 != fread(packed, row_bytes, 1, file)) {
+      fprintf(stderr, "Could not read %s: %s\n", path, strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+    unpack_cells(packed, header.size, row);
+    engine->load_row(world, y, row);
+  }
+
+  free(packed);
+  free(row);
+  fclose(file);
+}
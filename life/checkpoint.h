@@ -0,0 +1,65 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIFE_CHECKPOINT_H
+#define __LIFE_CHECKPOINT_H
+
+#include <stdbool.h>
+
+#include "engine.h"
+
+/* Checkpoints of a run, for --checkpoint-every and --resume. A checkpoint file
+   holds a 32-byte header and then the cells, one bit each:
+
+     bytes 0-7    "LIFECKP1"
+     bytes 8-15   size, little-endian
+     bytes 16-23  generation, little-endian
+     bytes 24-25  rule birth mask, little-endian
+     bytes 26-27  rule survival mask, little-endian
+     bytes 28-31  flags, little-endian: bit 0 set for --wrap
+     then         size rows of (size + 7) / 8 bytes, with cell x of a row in
+                  bit x % 8 of byte x / 8 */
+struct checkpoint;
+
+// What a checkpoint records besides the cells.
+struct checkpoint_header {
+  unsigned long size;
+  unsigned long generation;
+  struct rule rule;
+  bool wrap;
+};
+
+/* Checkpoints go to path. Each is written to a temporary file next to it that
+   is renamed over path once it is complete, so path always holds a whole
+   checkpoint. The writing is done by a thread of its own. */
+struct checkpoint *checkpoint_create (const char *path, const struct life_config *config);
+/* Copies world, which is at generation generation, and has the copy written
+   out in the background. If the last checkpoint is still being written, waits
+   for it to finish first. */
+void checkpoint_save (struct checkpoint *checkpoint, const struct engine *engine, const void *world,
+                      const unsigned long generation);
+// Waits for the last checkpoint to be written, then frees checkpoint.
+void checkpoint_destroy (struct checkpoint *checkpoint);
+
+// Reads the header of the checkpoint at path; exits if it is not a checkpoint.
+void checkpoint_read_header (const char *path, struct checkpoint_header *header);
+// Loads the cells of the checkpoint at path into world, which has its size.
+void checkpoint_load (const char *path, const struct engine *engine, void *world);
+
+/* __LIFE_CHECKPOINT_H */
+#endif
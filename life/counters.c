@@ -0,0 +1,247 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Performance counters for --counters. Each counter is opened by perf_event_open()
+on its own (not as a group, so that one the CPU lacks does not take the others
+down with it), counting user space only, for the thread that opens it. The
+threads of the pool open theirs in a pool job, and all of them are enabled and
+disabled together from the main thread around each stretch of computing
+generations, so neither printing nor cycle detection is counted. Counts from
+counters that the kernel had to multiplex are scaled up by the time they were
+enabled over the time they ran.
+
+When --counters is not given there is no struct counters, and the only cost is
+a NULL test per stretch of generations.
+*/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "counters.h"
+
+enum {
+  COUNTER_CYCLES,
+  COUNTER_INSTRUCTIONS,
+  COUNTER_L1D_MISSES,
+  COUNTER_LLC_MISSES,
+  COUNTER_BRANCH_MISSES,
+  // Faults taken while computing, which first touches of the grids show up in.
+  COUNTER_PAGE_FAULTS,
+  // Not a hardware counter, but it is always there and puts the others in proportion.
+  COUNTER_TASK_CLOCK,
+  COUNTERS,
+};
+
+static const struct {
+  const char *name;
+  uint32_t type;
+  uint64_t config;
+} counter_kinds[COUNTERS] = {
+  [COUNTER_CYCLES] = { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+  [COUNTER_INSTRUCTIONS] = { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+  [COUNTER_L1D_MISSES] = { "L1d-misses", PERF_TYPE_HW_CACHE,
+                           PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                             | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+  [COUNTER_LLC_MISSES] = { "LLC-misses", PERF_TYPE_HW_CACHE,
+                           PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                             | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+  [COUNTER_BRANCH_MISSES] = { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+  [COUNTER_PAGE_FAULTS] = { "page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+  [COUNTER_TASK_CLOCK] = { "task-clock-ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+};
+
+struct counters {
+  unsigned long threads;
+  // COUNTERS file descriptors per thread, -1 for counters that could not be opened.
+  int *fds;
+  // Error from opening each counter on the main thread, 0 if it opened.
+  int errors[COUNTERS];
+  unsigned long band;
+  // The current band starts after generation band_start, where the counts were band_counts.
+  unsigned long band_start;
+  uint64_t band_counts[COUNTERS];
+  // Last generation computed.
+  unsigned long generation;
+};
+
+static int
+counter_open (const int kind)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = counter_kinds[kind].type;
+  attr.config = counter_kinds[kind].config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// Pool job opening this thread's counters.
+static void
+counters_open_job (void *arg, const unsigned long thread, const unsigned long threads)
+{
+  struct counters *counters = arg;
+  (void)threads;
+  for (int kind = 0; kind < COUNTERS; kind++) {
+    int *fd = &counters->fds[thread * COUNTERS + (unsigned long)kind];
+    *fd = counter_open(kind);
+    if (0 == thread)
+      counters->errors[kind] = *fd < 0 ? errno : 0;
+  }
+}
+
+// Count of kind summed over the threads, scaled up where it was multiplexed.
+static uint64_t
+counters_read (const struct counters *counters, const int kind)
+{
+  uint64_t total = 0;
+  for (unsigned long thread = 0; thread < counters->threads; thread++) {
+    const int fd = counters->fds[thread * COUNTERS + (unsigned long)kind];
+    // value, time enabled, time running
+    uint64_t values[3];
+    if (fd < 0 || sizeof(values) != read(fd, values, sizeof(values)))
+      continue;
+    if (values[2] > 0 && values[2] < values[1])
+      values[0] = (uint64_t)((double)values[0] * (double)values[1] / (double)values[2]);
+    total += values[0];
+  }
+  return total;
+}
+
+static void
+counters_ioctl (const struct counters *counters, const unsigned long request)
+{
+  for (unsigned long i = 0; i < counters->threads * COUNTERS; i++) {
+    if (counters->fds[i] >= 0)
+      ioctl(counters->fds[i], request, 0);
+  }
+}
+
+struct counters *
+counters_create (struct pool *pool, const unsigned long band)
+{
+  struct counters *counters = calloc(1, sizeof(*counters));
+  counters->threads = NULL != pool ? pool_threads(pool) : 1;
+  counters->fds = malloc(counters->threads * COUNTERS * sizeof(int));
+  counters->band = band;
+  if (NULL != pool)
+    pool_run(pool, counters_open_job, counters);
+  else
+    counters_open_job(counters, 0, 1);
+
+  // One line naming every counter that could not be opened, and why.
+  int opened = 0;
+  for (int kind = 0; kind < COUNTERS; kind++) {
+    if (0 == counters->errors[kind]) {
+      opened++;
+      continue;
+    }
+    fprintf(stderr, "%s %s (%s)", kind == opened ? "Counters not available:" : ",", counter_kinds[kind].name,
+            strerror(counters->errors[kind]));
+  }
+  if (opened < COUNTERS)
+    fprintf(stderr, "\n");
+  if (0 == opened) {
+    counters_destroy(counters);
+    return NULL;
+  }
+  return counters;
+}
+
+void
+counters_start (struct counters *counters)
+{
+  counters_ioctl(counters, PERF_EVENT_IOC_ENABLE);
+}
+
+// Reports the counts since counts, over generations (first, last].
+static void
+counters_report (const struct counters *counters, const char *what, const unsigned long first,
+                 const unsigned long last, const uint64_t counts[COUNTERS])
+{
+  uint64_t now[COUNTERS];
+  fprintf(stderr, "%s %lu-%lu:", what, first + 1, last);
+  for (int kind = 0; kind < COUNTERS; kind++) {
+    now[kind] = counters_read(counters, kind) - counts[kind];
+    if (0 == counters->errors[kind])
+      fprintf(stderr, " %s %llu", counter_kinds[kind].name, (unsigned long long)now[kind]);
+    else
+      fprintf(stderr, " %s n/a", counter_kinds[kind].name);
+  }
+  if (0 == counters->errors[COUNTER_CYCLES] && 0 == counters->errors[COUNTER_INSTRUCTIONS]
+      && now[COUNTER_CYCLES] > 0)
+    fprintf(stderr, " IPC %.2f", (double)now[COUNTER_INSTRUCTIONS] / (double)now[COUNTER_CYCLES]);
+  fprintf(stderr, "\n");
+}
+
+void
+counters_stop (struct counters *counters, const unsigned long generation)
+{
+  counters_ioctl(counters, PERF_EVENT_IOC_DISABLE);
+  counters->generation = generation;
+  if (0 == counters->band || generation - counters->band_start < counters->band)
+    return;
+
+  counters_report(counters, "Counters for generations", counters->band_start, generation,
+                  counters->band_counts);
+  for (int kind = 0; kind < COUNTERS; kind++)
+    counters->band_counts[kind] = counters_read(counters, kind);
+  counters->band_start = generation;
+}
+
+void
+counters_destroy (struct counters *counters)
+{
+  const uint64_t zero[COUNTERS] = { 0 };
+  int opened = 0;
+  for (int kind = 0; kind < COUNTERS; kind++)
+    opened += 0 == counters->errors[kind];
+  if (opened > 0) {
+    // The band cut short by the end of the run, then the whole run.
+    if (counters->band > 0 && counters->generation > counters->band_start)
+      counters_report(counters, "Counters for generations", counters->band_start, counters->generation,
+                      counters->band_counts);
+    counters_report(counters, "Counters for the run, generations", 0, counters->generation, zero);
+  }
+
+  // The whole process, loading and output included, from the kernel's own accounts.
+  struct rusage usage;
+  if (0 == getrusage(RUSAGE_SELF, &usage))
+    fprintf(stderr, "Memory for the run: peak-rss-kib %ld minor-faults %ld major-faults %ld\n", usage.ru_maxrss,
+            usage.ru_minflt, usage.ru_majflt);
+
+  for (unsigned long i = 0; i < counters->threads * COUNTERS; i++) {
+    if (counters->fds[i] >= 0)
+      close(counters->fds[i]);
+  }
+  free(counters->fds);
+  free(counters);
+}
@@ -0,0 +1,43 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIFE_COUNTERS_H
+#define __LIFE_COUNTERS_H
+
+#include "pool.h"
+
+/* Hardware performance counters (cycles, instructions, L1d and LLC misses,
+   branch misses, and page faults) read through perf_event_open(2), counting only while
+   generations are being computed, on every thread that computes them. */
+struct counters;
+
+/* Opens the counters for the calling thread and for every thread of pool, if
+   it is not NULL. With band > 0 the counts are also reported every band
+   generations. Counters that the kernel or the CPU does not have are reported
+   as n/a; if there are none at all, there is a warning and NULL is returned. */
+struct counters *counters_create (struct pool *pool, const unsigned long band);
+// Starts counting.
+void counters_start (struct counters *counters);
+// Stops counting, now that generation generation has been computed.
+void counters_stop (struct counters *counters, const unsigned long generation);
+/* Reports the counts of the whole run, and the peak RSS and page faults of
+   the whole process, then closes the counters. */
+void counters_destroy (struct counters *counters);
+
+/* __LIFE_COUNTERS_H */
+#endif
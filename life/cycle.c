@@ -0,0 +1,225 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Cycle detection for --detect-cycles. Every generation is hashed to 64 bits and
+the hash goes into a ring holding those of the last CYCLE_WINDOW generations.
+A generation whose hash is in the ring repeats the generation it belongs to,
+p generations back, and then so does every generation after it: the world has
+become periodic with period p (the smallest such p is taken).
+
+For --early-exit the p states of the cycle are then kept, packed 64 cells to a
+word, by watching the next p generations go by. Each of those must also hash
+the same as the one p generations before it, and the last of them, which is
+the first state over again, must match it cell for cell, which guards against
+a collision of hashes (for p = 1, that comparison is the only guard). Any
+generation after that is one of the kept states, and replay_engine reads it
+from there.
+*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cycle.h"
+
+// Longest period looked for.
+#define CYCLE_WINDOW 64
+// Independent multiply chains when hashing, so that they overlap in the pipeline.
+#define CYCLE_LANES 4
+
+struct cycle {
+  unsigned long size;
+  // Words in a packed row.
+  unsigned long words;
+  bool replay;
+  char *row;
+
+  // Hash of generation g is in hashes[g % CYCLE_WINDOW] if generations[] there is g.
+  uint64_t hashes[CYCLE_WINDOW];
+  unsigned long generations[CYCLE_WINDOW];
+  bool recorded[CYCLE_WINDOW];
+
+  bool found;
+  unsigned long period;
+  unsigned long repeat;
+  /* The kept states: state i is generation repeat + i, size * words words.
+     There is room for period + 1 of them, the last being the first again. */
+  uint64_t *states;
+  unsigned long kept;
+  // The state that replay_engine reads.
+  const uint64_t *current;
+};
+
+struct cycle *
+cycle_create (const unsigned long size, const bool replay)
+{
+  struct cycle *cycle = calloc(1, sizeof(*cycle));
+  cycle->size = size;
+  cycle->words = (size + 63) / 64;
+  cycle->replay = replay;
+  cycle->row = malloc(size);
+  return cycle;
+}
+
+static uint64_t
+cycle_hash (struct cycle *cycle, const struct engine *engine, const void *world)
+{
+  const uint64_t prime = 0x100000001b3ULL;
+  uint64_t lanes[CYCLE_LANES] = { 1, 2, 3, 4 };
+  for (unsigned long y = 0; y < cycle->size; y++) {
+    engine->read_row(world, y, cycle->row);
+    unsigned long x = 0;
+    for (; x + 8 * CYCLE_LANES <= cycle->size; x += 8 * CYCLE_LANES) {
+      for (int lane = 0; lane < CYCLE_LANES; lane++) {
+        uint64_t cells;
+        memcpy(&cells, cycle->row + x + 8 * lane, sizeof(cells));
+        lanes[lane] = (lanes[lane] ^ cells) * prime;
+      }
+    }
+    for (; x < cycle->size; x++)
+      lanes[0] = (lanes[0] ^ (uint64_t)(unsigned char)cycle->row[x]) * prime;
+  }
+
+  uint64_t hash = 0;
+  for (int lane = 0; lane < CYCLE_LANES; lane++) {
+    hash = (hash ^ lanes[lane]) * prime;
+    hash ^= hash >> 29;
+  }
+  return hash;
+}
+
+// Keeps the current generation of world as state cycle->kept.
+static void
+cycle_keep (struct cycle *cycle, const struct engine *engine, const void *world)
+{
+  uint64_t *state = cycle->states + cycle->kept * cycle->size * cycle->words;
+  memset(state, 0, cycle->size * cycle->words * sizeof(uint64_t));
+  for (unsigned long y = 0; y < cycle->size; y++) {
+    engine->read_row(world, y, cycle->row);
+    uint64_t *words = state + y * cycle->words;
+    for (unsigned long x = 0; x < cycle->size; x++)
+      words[x / 64] |= (uint64_t)(unsigned char)cycle->row[x] << (x % 64);
+  }
+  cycle->kept++;
+}
+
+// Whether the hash of generation generation is in the ring and equal to hash.
+static bool
+cycle_seen (const struct cycle *cycle, const unsigned long generation, const uint64_t hash)
+{
+  const unsigned long slot = generation % CYCLE_WINDOW;
+  return cycle->recorded[slot] && generation == cycle->generations[slot] && hash == cycle->hashes[slot];
+}
+
+bool
+cycle_record (struct cycle *cycle, const struct engine *engine, const void *world, const unsigned long generation)
+{
+  if (cycle->found && (!cycle->replay || cycle_replaying(cycle)))
+    return false;
+
+  const uint64_t hash = cycle_hash(cycle, engine, world);
+  bool done = false;
+  if (!cycle->found) {
+    for (unsigned long period = 1; period <= CYCLE_WINDOW && period <= generation; period++) {
+      if (cycle_seen(cycle, generation - period, hash)) {
+        cycle->found = true;
+        cycle->period = period;
+        cycle->repeat = generation;
+        break;
+      }
+    }
+    if (cycle->found && cycle->replay) {
+      cycle->states = malloc((cycle->period + 1) * cycle->size * cycle->words * sizeof(uint64_t));
+      cycle->kept = 0;
+      cycle_keep(cycle, engine, world);
+    } else {
+      done = cycle->found;
+    }
+  } else if (cycle_seen(cycle, generation - cycle->period, hash)) {
+    cycle_keep(cycle, engine, world);
+    const unsigned long state_words = cycle->size * cycle->words;
+    if (cycle->kept == cycle->period + 1) {
+      done = 0 == memcmp(cycle->states, cycle->states + cycle->period * state_words, state_words * sizeof(uint64_t));
+      if (!done) {
+        free(cycle->states);
+        cycle->states = NULL;
+        cycle->found = false;
+      }
+    }
+  } else {
+    // Two generations that differ had the same hash: keep looking.
+    free(cycle->states);
+    cycle->states = NULL;
+    cycle->found = false;
+  }
+
+  const unsigned long slot = generation % CYCLE_WINDOW;
+  cycle->hashes[slot] = hash;
+  cycle->generations[slot] = generation;
+  cycle->recorded[slot] = true;
+  return done;
+}
+
+bool
+cycle_replaying (const struct cycle *cycle)
+{
+  return cycle->found && cycle->replay && cycle->kept == cycle->period + 1;
+}
+
+unsigned long
+cycle_period (const struct cycle *cycle)
+{
+  return cycle->period;
+}
+
+unsigned long
+cycle_repeat (const struct cycle *cycle)
+{
+  return cycle->repeat;
+}
+
+void
+cycle_seek (struct cycle *cycle, const unsigned long generation)
+{
+  assert(cycle_replaying(cycle) && generation >= cycle->repeat);
+  const unsigned long state = (generation - cycle->repeat) % cycle->period;
+  cycle->current = cycle->states + state * cycle->size * cycle->words;
+}
+
+void
+cycle_destroy (struct cycle *cycle)
+{
+  free(cycle->row);
+  free(cycle->states);
+  free(cycle);
+}
+
+static void
+replay_read_row (const void *state, const unsigned long y, char *row)
+{
+  const struct cycle *cycle = state;
+  const uint64_t *words = cycle->current + y * cycle->words;
+  for (unsigned long x = 0; x < cycle->size; x++)
+    row[x] = (char)((words[x / 64] >> (x % 64)) & 1);
+}
+
+const struct engine replay_engine = {
+  .name = "replay",
+  .read_row = replay_read_row,
+};
@@ -0,0 +1,52 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIFE_CYCLE_H
+#define __LIFE_CYCLE_H
+
+#include <stdbool.h>
+
+#include "engine.h"
+
+/* Watches the generations of a world go by for one that repeats one of the
+   last CYCLE_WINDOW, i.e. for a still life (period 1) or an oscillator. */
+struct cycle;
+
+/* With replay set, the states of a cycle are kept once it is found, so the
+   generations after it can be read without computing them. */
+struct cycle *cycle_create (const unsigned long size, const bool replay);
+/* Takes note of the current generation of world, which is generation number
+   generation. Returns true once, when a cycle is found; if replay was asked
+   for, that is only once its states have all been kept and the cycle has been
+   checked cell for cell, and from then on cycle_replaying() holds. */
+bool cycle_record (struct cycle *cycle, const struct engine *engine, const void *world,
+                   const unsigned long generation);
+bool cycle_replaying (const struct cycle *cycle);
+// Length of the cycle found, and the first generation that repeats an earlier one.
+unsigned long cycle_period (const struct cycle *cycle);
+unsigned long cycle_repeat (const struct cycle *cycle);
+/* While replaying: makes replay_engine read generation generation, which can
+   be any generation after the cycle was found, from cycle. */
+void cycle_seek (struct cycle *cycle, const unsigned long generation);
+void cycle_destroy (struct cycle *cycle);
+
+// Only has read_row(), which reads the generation picked by cycle_seek().
+extern const struct engine replay_engine;
+
+/* __LIFE_CYCLE_H */
+#endif
@@ -0,0 +1,126 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIFE_ENGINE_H
+#define __LIFE_ENGINE_H
+
+#include <stdbool.h>
+
+#include "arena.h"
+#include "rule.h"
+
+// Deepest --block-depth, at which each scratch square of the blocked engine is about 17 MiB.
+#define BLOCK_MAX_DEPTH 2048
+
+// Parameters that every engine is created with.
+struct life_config {
+  unsigned long size;
+  struct rule rule;
+  /* The world is a torus (--wrap): cells on one edge neighbour those on the
+     opposite edge, rather than dead cells. Unbounded engines ignore it. */
+  bool wrap;
+  // Memory budget of the hashlife engine, in MiB.
+  unsigned long hash_memory;
+  /* Generations the blocked engine computes per pass over the world, at most
+     BLOCK_MAX_DEPTH: its scratch squares are 2 * depth cells wider than a tile. */
+  unsigned long block_depth;
+  // Directory the mmap engine keeps its world files in.
+  const char *mmap_dir;
+  // How the engines that keep their grids in an arena map it.
+  struct arena_config arena;
+  // Engines with a stats function keep count of each step as they compute it (--stats).
+  bool stats;
+};
+
+/* A generation in numbers: its live cells, the cells born and the cells that
+   died since the generation before, and the box that the live cells lie in,
+   [min_x, max_x] x [min_y, max_y], which means nothing if there are none. */
+struct life_stats {
+  unsigned long population;
+  unsigned long births;
+  unsigned long deaths;
+  unsigned long min_x;
+  unsigned long min_y;
+  unsigned long max_x;
+  unsigned long max_y;
+};
+
+/* An engine holds the current generation of a size x size world and knows how
+   to compute the next one. Rows cross the interface as size bytes holding 0 or
+   1, which is the layout that -i reads and that the writers in output.c (--format
+   text and the rest) take, so the rest of the program does not care how an
+   engine stores its cells. */
+struct engine {
+  const char *name;
+  /* Set for engines that run on an unbounded plane, of which the size x size
+     world is only the window that rows are loaded into and read from. */
+  bool unbounded;
+  /* Set for engines that keep the world in files rather than memory, which
+     nothing else should then hold copies of either. */
+  bool out_of_core;
+  // The last generation the engine can reach, or 0 if there is no limit.
+  unsigned long max_generations;
+  // Returns a world with every cell dead.
+  void *(*create) (const struct life_config *config);
+  // Overwrites row y of the current generation.
+  void (*load_row) (void *world, const unsigned long y, const char *row);
+  // Copies row y of the current generation into row.
+  void (*read_row) (const void *world, const unsigned long y, char *row);
+  // Replaces the current generation with the next one.
+  void (*step) (void *world);
+  /* Optional, for engines whose rows can be computed independently: step_rows
+     computes rows [begin, end) of the next generation and may run on several
+     threads at once for disjoint ranges; commit then makes the next generation
+     current. Together they do what step does. */
+  void (*step_rows) (void *world, const unsigned long begin, const unsigned long end);
+  void (*commit) (void *world);
+  /* Optional, for engines that can skip ahead: advances by the given number of
+     generations, faster than calling step that many times. */
+  void (*advance) (void *world, const unsigned long generations);
+  /* Optional, for engines created with config->stats set: the numbers of the
+     current generation, as counted while the step that made it was computed.
+     Only valid once there has been a step. */
+  void (*stats) (const void *world, struct life_stats *stats);
+  void (*destroy) (void *world);
+};
+
+extern const struct engine byte_engine;
+extern const struct engine bit_engine;
+extern const struct engine simd_engine;
+extern const struct engine tile_engine;
+extern const struct engine hash_engine;
+extern const struct engine sparse_engine;
+extern const struct engine block_engine;
+extern const struct engine lut_engine;
+extern const struct engine mmap_engine;
+
+// Every engine that -e can pick.
+extern const struct engine *const engines[];
+extern const unsigned long engine_count;
+
+// Looks an engine up by the name given to -e; NULL if there is none.
+const struct engine *find_engine (const char *name);
+
+struct pool;
+/* Advances world by the given number of generations, on the threads of pool
+   if it is not NULL, and skipping ahead if the engine can. */
+void advance_world (const struct engine *engine, void *world, const unsigned long size, struct pool *pool,
+                    const unsigned long generations);
+
+/* __LIFE_ENGINE_H */
+#endif
@@ -0,0 +1,583 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+HashLife engine (Gosper's algorithm). The world is a quadtree whose nodes are
+canonical: two squares with the same cells are the same node, found through a
+hash table. A node at level k is a 2^k x 2^k square, and for k >= 2 it
+memoises its "result": its centre 2^(k-1) square, 2^j generations on, where j
+is at most k - 2. Repeated regions, in space or in time, are then computed
+once, and advancing by 2^j generations costs about as much as one generation.
+
+Unlike the other engines this one runs on an unbounded plane: the tree grows to
+fit the pattern, and nothing dies at the edge of the -s window. Rows outside
+the window are simply not shown.
+
+Nodes live in one array and refer to each other by index. The array grows up to
+the --hash-mem budget. When it is full, the memoised results are dropped and
+every node the current world does not use is freed. If a step still does not
+fit, it is split into two half-sized steps.
+*/
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+
+// Node 0 stands for "no node" (no result yet, or out of memory).
+#define HL_NONE 0
+#define HL_DEAD 1
+#define HL_ALIVE 2
+// level of a slot on the free list.
+#define HL_FREE 0xff
+/* The deepest root: a 2^62 square, whose corners still fit in the int64_t
+   origin with room to spare for its side. */
+#define HL_MAX_LEVEL 62
+#define HL_MIN_SLOTS (1UL << 16)
+
+struct hl_node {
+  uint32_t nw, ne, sw, se;
+  // Memoised result, or HL_NONE.
+  uint32_t result;
+  // Next node in the same hash bucket, or on the free list.
+  uint32_t next;
+  uint8_t level;
+  uint8_t mark;
+};
+
+struct hash_world {
+  unsigned long size;
+  uint32_t rule;
+  struct hl_node *nodes;
+  // One chain per bucket; there are as many buckets as slots.
+  uint32_t *buckets;
+  unsigned long slots;
+  unsigned long max_slots;
+  // Slots handed out so far, free or not.
+  unsigned long used;
+  unsigned long live;
+  uint32_t free_list;
+  // Set when a node was needed but the memory budget was exhausted.
+  bool overflow;
+  // Memoised results advance nodes by 2^step_log generations; -1 if none are.
+  int step_log;
+  uint32_t empty[HL_MAX_LEVEL + 1];
+  uint32_t root;
+  // Position of the root's top-left cell on the plane.
+  int64_t origin_x;
+  int64_t origin_y;
+  // Cells loaded with load_row() that have not been built into a tree yet.
+  char *pending;
+};
+
+static uint32_t
+hl_hash (const uint32_t nw, const uint32_t ne, const uint32_t sw, const uint32_t se)
+{
+  uint64_t h = nw;
+  h = h * 0x9e3779b97f4a7c15ULL + ne;
+  h = h * 0x9e3779b97f4a7c15ULL + sw;
+  h = h * 0x9e3779b97f4a7c15ULL + se;
+  return (uint32_t)(h ^ (h >> 29));
+}
+
+// Re-threads every node into the bucket chains, e.g. after they were resized.
+static void
+hl_rehash (struct hash_world *hw)
+{
+  memset(hw->buckets, 0, hw->slots * sizeof(uint32_t));
+  for (uint32_t i = HL_ALIVE + 1; i < hw->used; i++) {
+    struct hl_node *node = &hw->nodes[i];
+    if (HL_FREE == node->level)
+      continue;
+    const uint32_t b = hl_hash(node->nw, node->ne, node->sw, node->se) & (uint32_t)(hw->slots - 1);
+    node->next = hw->buckets[b];
+    hw->buckets[b] = i;
+  }
+}
+
+static bool
+hl_grow (struct hash_world *hw)
+{
+  if (hw->slots >= hw->max_slots)
+    return false;
+
+  hw->slots *= 2;
+  hw->nodes = realloc(hw->nodes, hw->slots * sizeof(struct hl_node));
+  hw->buckets = realloc(hw->buckets, hw->slots * sizeof(uint32_t));
+  hl_rehash(hw);
+  return true;
+}
+
+// Returns the canonical node with the given children.
+static uint32_t
+hl_find (struct hash_world *hw, const uint32_t nw, const uint32_t ne, const uint32_t sw, const uint32_t se, const int level)
+{
+  assert(level <= HL_MAX_LEVEL);
+  if (HL_NONE == nw || HL_NONE == ne || HL_NONE == sw || HL_NONE == se)
+    return HL_NONE;
+
+  const uint32_t h = hl_hash(nw, ne, sw, se);
+  for (uint32_t i = hw->buckets[h & (hw->slots - 1)]; HL_NONE != i; i = hw->nodes[i].next) {
+    const struct hl_node *node = &hw->nodes[i];
+    if (node->nw == nw && node->ne == ne && node->sw == sw && node->se == se)
+      return i;
+  }
+
+  uint32_t i = hw->free_list;
+  if (HL_NONE != i) {
+    hw->free_list = hw->nodes[i].next;
+  } else {
+    if (hw->used == hw->slots && !hl_grow(hw)) {
+      hw->overflow = true;
+      return HL_NONE;
+    }
+    i = (uint32_t)hw->used++;
+  }
+
+  struct hl_node *node = &hw->nodes[i];
+  node->nw = nw;
+  node->ne = ne;
+  node->sw = sw;
+  node->se = se;
+  node->result = HL_NONE;
+  node->level = (uint8_t)level;
+  node->mark = 0;
+  const uint32_t b = h & (uint32_t)(hw->slots - 1);
+  node->next = hw->buckets[b];
+  hw->buckets[b] = i;
+  hw->live++;
+  return i;
+}
+
+static uint32_t
+hl_empty (struct hash_world *hw, const int level)
+{
+  assert(level <= HL_MAX_LEVEL);
+  if (0 == level)
+    return HL_DEAD;
+  if (HL_NONE == hw->empty[level]) {
+    const uint32_t e = hl_empty(hw, level - 1);
+    hw->empty[level] = hl_find(hw, e, e, e, e, level);
+  }
+  return hw->empty[level];
+}
+
+static void
+hl_mark (struct hash_world *hw, const uint32_t i)
+{
+  if (i <= HL_ALIVE || hw->nodes[i].mark)
+    return;
+  hw->nodes[i].mark = 1;
+  hl_mark(hw, hw->nodes[i].nw);
+  hl_mark(hw, hw->nodes[i].ne);
+  hl_mark(hw, hw->nodes[i].sw);
+  hl_mark(hw, hw->nodes[i].se);
+}
+
+/* Evicts every memoised result and frees every node that neither the root nor
+   the empty squares use. */
+static void
+hl_collect (struct hash_world *hw)
+{
+  hl_mark(hw, hw->root);
+  for (int level = 0; level <= HL_MAX_LEVEL; level++)
+    hl_mark(hw, hw->empty[level]);
+
+  hw->free_list = HL_NONE;
+  hw->live = 0;
+  for (uint32_t i = (uint32_t)hw->used; i-- > HL_ALIVE + 1;) {
+    struct hl_node *node = &hw->nodes[i];
+    node->result = HL_NONE;
+    if (node->mark) {
+      node->mark = 0;
+      hw->live++;
+    } else {
+      node->level = HL_FREE;
+      node->next = hw->free_list;
+      hw->free_list = i;
+    }
+  }
+  hw->step_log = -1;
+  hl_rehash(hw);
+}
+
+static int
+hl_level (const struct hash_world *hw, const uint32_t i)
+{
+  return i <= HL_ALIVE ? 0 : hw->nodes[i].level;
+}
+
+static uint32_t
+hl_centre (struct hash_world *hw, const uint32_t i)
+{
+  const struct hl_node node = hw->nodes[i];
+  return hl_find(hw, hw->nodes[node.nw].se, hw->nodes[node.ne].sw, hw->nodes[node.sw].ne, hw->nodes[node.se].nw,
+                 node.level - 1);
+}
+
+// One generation of the centre 2x2 of a 4x4 node.
+static uint32_t
+hl_base (struct hash_world *hw, const uint32_t i)
+{
+  const struct hl_node node = hw->nodes[i];
+  const uint32_t quadrants[4] = { node.nw, node.ne, node.sw, node.se };
+  int cells[4][4];
+
+  for (int q = 0; q < 4; q++) {
+    const struct hl_node quadrant = hw->nodes[quadrants[q]];
+    const int y = q / 2 * 2;
+    const int x = q % 2 * 2;
+    cells[y][x] = HL_ALIVE == quadrant.nw;
+    cells[y][x + 1] = HL_ALIVE == quadrant.ne;
+    cells[y + 1][x] = HL_ALIVE == quadrant.sw;
+    cells[y + 1][x + 1] = HL_ALIVE == quadrant.se;
+  }
+
+  uint32_t next[4];
+  for (int c = 0; c < 4; c++) {
+    const int y = 1 + c / 2;
+    const int x = 1 + c % 2;
+    const int ln = cells[y - 1][x - 1] + cells[y - 1][x] + cells[y - 1][x + 1] + cells[y][x - 1] + cells[y][x + 1]
+                   + cells[y + 1][x - 1] + cells[y + 1][x] + cells[y + 1][x + 1];
+    next[c] = rule_next(hw->rule, cells[y][x], ln) ? HL_ALIVE : HL_DEAD;
+  }
+
+  return hl_find(hw, next[0], next[1], next[2], next[3], 1);
+}
+
+/* The centre of node i, 2^j generations on, where j <= level - 2 and j equals
+   step_log or is the largest step node i can take. */
+static uint32_t
+hl_next (struct hash_world *hw, const uint32_t i, const int j)
+{
+  if (HL_NONE != hw->nodes[i].result)
+    return hw->nodes[i].result;
+
+  const int level = hw->nodes[i].level;
+  uint32_t result;
+  if (2 == level) {
+    result = hl_base(hw, i);
+  } else {
+    const struct hl_node node = hw->nodes[i];
+    const struct hl_node nw = hw->nodes[node.nw];
+    const struct hl_node ne = hw->nodes[node.ne];
+    const struct hl_node sw = hw->nodes[node.sw];
+    const struct hl_node se = hw->nodes[node.se];
+
+    // The nine overlapping level - 1 squares covering node i.
+    uint32_t n[3][3];
+    n[0][0] = node.nw;
+    n[0][1] = hl_find(hw, nw.ne, ne.nw, nw.se, ne.sw, level - 1);
+    n[0][2] = node.ne;
+    n[1][0] = hl_find(hw, nw.sw, nw.se, sw.nw, sw.ne, level - 1);
+    n[1][1] = hl_find(hw, nw.se, ne.sw, sw.ne, se.nw, level - 1);
+    n[1][2] = hl_find(hw, ne.sw, ne.se, se.nw, se.ne, level - 1);
+    n[2][0] = node.sw;
+    n[2][1] = hl_find(hw, sw.ne, se.nw, sw.se, se.sw, level - 1);
+    n[2][2] = node.se;
+
+    /* At full speed both halves of the step advance 2^(level - 3)
+       generations. A shorter step only moves in the second half and uses the
+       plain centres in the first. */
+    const bool full = j == level - 2;
+    uint32_t r[3][3];
+    for (int y = 0; y < 3; y++) {
+      for (int x = 0; x < 3; x++) {
+        if (HL_NONE == n[y][x])
+          return HL_NONE;
+        r[y][x] = full ? hl_next(hw, n[y][x], level - 3) : hl_centre(hw, n[y][x]);
+        if (hw->overflow)
+          return HL_NONE;
+      }
+    }
+
+    const int second = full ? level - 3 : j;
+    uint32_t q[4];
+    for (int c = 0; c < 4; c++) {
+      const int y = c / 2;
+      const int x = c % 2;
+      const uint32_t square = hl_find(hw, r[y][x], r[y][x + 1], r[y + 1][x], r[y + 1][x + 1], level - 1);
+      if (HL_NONE == square)
+        return HL_NONE;
+      q[c] = hl_next(hw, square, second);
+      if (hw->overflow)
+        return HL_NONE;
+    }
+    result = hl_find(hw, q[0], q[1], q[2], q[3], level - 1);
+  }
+
+  if (HL_NONE != result)
+    hw->nodes[i].result = result;
+  return result;
+}
+
+// Whether everything alive lies in the centre half of the root.
+static bool
+hl_centred (struct hash_world *hw)
+{
+  const int level = hl_level(hw, hw->root);
+  if (level < 2)
+    return false;
+
+  const uint32_t e = hl_empty(hw, level - 2);
+  const struct hl_node root = hw->nodes[hw->root];
+  const struct hl_node nw = hw->nodes[root.nw];
+  const struct hl_node ne = hw->nodes[root.ne];
+  const struct hl_node sw = hw->nodes[root.sw];
+  const struct hl_node se = hw->nodes[root.se];
+  return e == nw.nw && e == nw.ne && e == nw.sw && e == ne.nw && e == ne.ne && e == ne.se && e == sw.nw && e == sw.sw
+         && e == sw.se && e == se.ne && e == se.sw && e == se.se;
+}
+
+// Doubles the root, keeping its contents in the middle.
+static uint32_t
+hl_expand (struct hash_world *hw)
+{
+  const int level = hl_level(hw, hw->root);
+  if (level >= HL_MAX_LEVEL) {
+    fprintf(stderr, "hashlife: the pattern has outgrown a 2^%d x 2^%d plane\n", HL_MAX_LEVEL, HL_MAX_LEVEL);
+    exit(EXIT_FAILURE);
+  }
+  const uint32_t e = hl_empty(hw, level - 1);
+  const struct hl_node root = hw->nodes[hw->root];
+  const uint32_t nw = hl_find(hw, e, e, e, root.nw, level);
+  const uint32_t ne = hl_find(hw, e, e, root.ne, e, level);
+  const uint32_t sw = hl_find(hw, e, root.sw, e, e, level);
+  const uint32_t se = hl_find(hw, root.se, e, e, e, level);
+  const uint32_t expanded = hl_find(hw, nw, ne, sw, se, level + 1);
+  if (HL_NONE == expanded)
+    return HL_NONE;
+
+  hw->root = expanded;
+  hw->origin_x -= (int64_t)1 << (level - 1);
+  hw->origin_y -= (int64_t)1 << (level - 1);
+  return expanded;
+}
+
+// Tries to advance the root by 2^j generations; false if memory ran out.
+static bool
+hl_try_step (struct hash_world *hw, const int j)
+{
+  if (hw->step_log != j) {
+    for (uint32_t i = HL_ALIVE + 1; i < hw->used; i++)
+      hw->nodes[i].result = HL_NONE;
+    hw->step_log = j;
+  }
+
+  /* Grow until the pattern sits in the centre half, then once more so that
+     it is at least 2^j cells from the edge of the part hl_next() returns. */
+  while (hl_level(hw, hw->root) < j + 2 || !hl_centred(hw)) {
+    if (HL_NONE == hl_expand(hw))
+      return false;
+  }
+  if (HL_NONE == hl_expand(hw))
+    return false;
+
+  const int level = hl_level(hw, hw->root);
+  const uint32_t next = hl_next(hw, hw->root, j);
+  if (HL_NONE == next)
+    return false;
+
+  hw->root = next;
+  hw->origin_x += (int64_t)1 << (level - 2);
+  hw->origin_y += (int64_t)1 << (level - 2);
+  return true;
+}
+
+static void
+hl_step_pow2 (struct hash_world *hw, const int j)
+{
+  const uint32_t root = hw->root;
+  const int64_t origin_x = hw->origin_x;
+  const int64_t origin_y = hw->origin_y;
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    hw->overflow = false;
+    if (hl_try_step(hw, j))
+      return;
+
+    // Out of memory: evict the cache and start the step again.
+    hw->root = root;
+    hw->origin_x = origin_x;
+    hw->origin_y = origin_y;
+    hw->overflow = false;
+    hl_collect(hw);
+  }
+
+  if (0 == j) {
+    fprintf(stderr, "hashlife: the world does not fit in --hash-mem\n");
+    exit(EXIT_FAILURE);
+  }
+  hl_step_pow2(hw, j - 1);
+  hl_step_pow2(hw, j - 1);
+}
+
+// The node for the size x size cells of pending at (x, y), 2^level on a side.
+static uint32_t
+hl_build (struct hash_world *hw, const unsigned long x, const unsigned long y, const int level)
+{
+  if (x >= hw->size || y >= hw->size)
+    return hl_empty(hw, level);
+  if (0 == level)
+    return hw->pending[y * hw->size + x] ? HL_ALIVE : HL_DEAD;
+
+  const unsigned long half = 1UL << (level - 1);
+  return hl_find(hw, hl_build(hw, x, y, level - 1), hl_build(hw, x + half, y, level - 1),
+                 hl_build(hw, x, y + half, level - 1), hl_build(hw, x + half, y + half, level - 1), level);
+}
+
+static void
+hl_flush_pending (struct hash_world *hw)
+{
+  if (NULL == hw->pending)
+    return;
+
+  int level = 3;
+  while ((1UL << level) < hw->size)
+    level++;
+  hw->root = hl_build(hw, 0, 0, level);
+  if (HL_NONE == hw->root) {
+    fprintf(stderr, "hashlife: the initial world does not fit in --hash-mem\n");
+    exit(EXIT_FAILURE);
+  }
+  hw->origin_x = 0;
+  hw->origin_y = 0;
+  free(hw->pending);
+  hw->pending = NULL;
+}
+
+static void *
+hash_create (const struct life_config *config)
+{
+  struct hash_world *hw = calloc(1, sizeof(*hw));
+  hw->size = config->size;
+  hw->rule = rule_mask(&config->rule);
+  hw->max_slots = HL_MIN_SLOTS;
+  const unsigned long budget = config->hash_memory << 20;
+  while (hw->max_slots * 2 * (sizeof(struct hl_node) + sizeof(uint32_t)) <= budget && hw->max_slots < (1UL << 31))
+    hw->max_slots *= 2;
+
+  hw->slots = HL_MIN_SLOTS;
+  hw->nodes = calloc(hw->slots, sizeof(struct hl_node));
+  hw->buckets = calloc(hw->slots, sizeof(uint32_t));
+  hw->used = HL_ALIVE + 1;
+  hw->step_log = -1;
+  hw->pending = calloc(config->size * config->size, 1);
+  return hw;
+}
+
+static void
+hash_load_row (void *state, const unsigned long y, const char *row)
+{
+  struct hash_world *hw = state;
+  if (NULL == hw->pending) {
+    fprintf(stderr, "hashlife: rows can only be loaded before the world is stepped\n");
+    exit(EXIT_FAILURE);
+  }
+  memcpy(hw->pending + y * hw->size, row, hw->size);
+}
+
+// Marks the live cells of node i, whose top-left cell is at (x, y), in row.
+static void
+hl_render_row (const struct hash_world *hw, const uint32_t i, const int64_t x, const int64_t y, const int64_t row_y,
+               char *row)
+{
+  const int level = hl_level(hw, i);
+  const int64_t side = (int64_t)1 << level;
+  if (HL_DEAD == i || x >= (int64_t)hw->size || x + side <= 0 || hw->empty[level] == i)
+    return;
+  if (HL_ALIVE == i) {
+    row[x] = 1;
+    return;
+  }
+
+  const int64_t half = side / 2;
+  const struct hl_node node = hw->nodes[i];
+  if (row_y < y + half) {
+    hl_render_row(hw, node.nw, x, y, row_y, row);
+    hl_render_row(hw, node.ne, x + half, y, row_y, row);
+  } else {
+    hl_render_row(hw, node.sw, x, y + half, row_y, row);
+    hl_render_row(hw, node.se, x + half, y + half, row_y, row);
+  }
+}
+
+static void
+hash_read_row (const void *state, const unsigned long y, char *row)
+{
+  const struct hash_world *hw = state;
+  if (NULL != hw->pending) {
+    memcpy(row, hw->pending + y * hw->size, hw->size);
+    return;
+  }
+
+  memset(row, 0, hw->size);
+  const int64_t side = (int64_t)1 << hl_level(hw, hw->root);
+  if ((int64_t)y >= hw->origin_y && (int64_t)y < hw->origin_y + side)
+    hl_render_row(hw, hw->root, hw->origin_x, hw->origin_y, (int64_t)y, row);
+}
+
+static void
+hash_advance (void *state, const unsigned long generations)
+{
+  struct hash_world *hw = state;
+  hl_flush_pending(hw);
+
+  // Keep the cache from filling up in the middle of a step where possible.
+  if (hw->live > hw->max_slots / 4 * 3)
+    hl_collect(hw);
+
+  for (int j = 63; j >= 0; j--) {
+    if (generations & (1UL << j))
+      hl_step_pow2(hw, j);
+  }
+}
+
+static void
+hash_step (void *state)
+{
+  hash_advance(state, 1);
+}
+
+static void
+hash_destroy (void *state)
+{
+  struct hash_world *hw = state;
+  free(hw->nodes);
+  free(hw->buckets);
+  free(hw->pending);
+  free(hw);
+}
+
+const struct engine hash_engine = {
+  .name = "hashlife",
+  .unbounded = true,
+  /* A step of 2^j generations needs a root of level j + 3, and a pattern that
+     spreads by up to a cell a generation has to stay in the centre half of
+     it, so 2^58 generations keep the root within HL_MAX_LEVEL. */
+  .max_generations = 1UL << 58,
+  .create = hash_create,
+  .load_row = hash_load_row,
+  .read_row = hash_read_row,
+  .step = hash_step,
+  .advance = hash_advance,
+  .destroy = hash_destroy,
+};
@@ -23,46 +23,148 @@ valgrind -s --leak-check=full --show-leak-kinds=all ./life -s 20 -c 20 -i 010000
 ./life -s 20 -c 10 -i 011001010110101111011001010110101111010111101010101111100110111
 Glider and blinker:
 ./life -s 20 -c 20 -i 010000000001000000000010000000010000000011100000000100000000
+Same, computed 64 cells at a time by the bit-packed engine:
+./life -e bit -s 20 -c 20 -i 010000000001000000000010000000010000000011100000000100000000
+or with the vectorised byte engine (SSE2/AVX2/AVX-512, picked at runtime):
+./life -e simd -s 20 -c 20 -i 010000000001000000000010000000010000000011100000000100000000
+or split into row bands over 4 threads, each pinned to its own CPU:
+./life -e simd -t 4 --pin -s 20 -c 20 -i 010000000001000000000010000000010000000011100000000100000000
+or only recomputing the parts of the world that are still changing:
+./life -e tile -s 20 -c 20 -i 010000000001000000000010000000010000000011100000000100000000
+Only print generations 0, 10 and 1000000000, skipping ahead with HashLife (which
+runs on an unbounded plane; -s is only the window that gets printed):
+./life -e hashlife --hash-mem 512 -s 20 -g 0,10,1000000000 -i 010000000001000000000010000000010000000011100000000100000000
+Only storing live cells, also on an unbounded plane:
+./life -e sparse -s 20 -c 20 -i 010000000001000000000010000000010000000011100000000100000000
+Advancing 16 generations per pass over memory, printing every 64th generation:
+./life -e blocked --block-depth 16 -s 20 -g 0,64,128,192 -i 010000000001000000000010000000010000000011100000000100000000
+Stepping 2x2 blocks through a 4x4 -> 2x2 lookup table:
+./life -e lut -s 20 -c 20 -i 010000000001000000000010000000010000000011100000000100000000
+Keeping both generations in files under /scratch instead of memory:
+./life -e mmap --mmap-dir /scratch -s 20 -c 20 -i 010000000001000000000010000000010000000011100000000100000000
+Reading the initial state from an RLE or plaintext (.cells) file, or stdin:
+./life -e bit -s 2048 -c 10 -f gosper_glider_gun.rle
+cat glider.cells | ./life -s 20 -c 20 -f -
+Writing each generation as an RLE pattern, or as a PBM image, instead of text:
+./life -s 20 -c 20 --format=rle -i 010000000001000000000010000000010000000011100000000100000000
+./life -e bit -s 4096 -c 100 --format=pbm -f gosper_glider_gun.rle > frames.pbm
+Only writing the cells that flipped, with a full keyframe every 1000 generations:
+./life -e tile -s 1000 -c 10000 --format=delta --keyframe-every 1000 -f gosper_glider_gun.rle > life.delta
+Formatting and writing generations on a thread of its own while up to 16 more
+are computed (the default is 4; 0 does it all between steps). The queue takes
+at most 64 MiB, so big worlds get fewer slots, and worlds of over 64 MiB
+packed (larger than about 23000 x 23000) or on -e mmap are written between
+steps whatever --output-queue says:
+./life -e bit -s 4096 -c 1000 --format=pbm --output-queue 16 -f gosper_glider_gun.rle > frames.pbm
+Stopping once the world settles, and replaying the cycle it settled into for the
+remaining generations (the period goes to stderr):
+./life -s 10 -c 1000000 --early-exit -i 010000000001000000000010000000010000000011100000000100000000 > life.out
+Timing every engine on random worlds of several sizes and densities, with no
+output but the timings, as JSON (or CSV with --bench-format=csv):
+./life --bench --bench-sizes 256,1024 --bench-densities 0.1,0.5 --bench-generations 100 --bench-repeat 5
+Running HighLife (B36/S23) rather than Conway's rule (B3/S23); any life-like
+rule can be given, in B/S or S/B notation:
+./life -e bit -r B36/S23 -s 20 -c 20 -i 010000000001000000000010000000010000000011100000000100000000
+Running every world in sweep.txt (one per line, as -i takes them) to generation
+99 together, 256 at a time, with one line per world out:
+./life --batch sweep.txt -s 5 -c 100 > results.txt
+Writing a checkpoint every 100000 generations, and carrying on from the last one
+after a crash (its size, rule and --wrap come from the checkpoint):
+./life -e bit -s 16384 -c 1000000 -g 1000000 --checkpoint-every 100000 --checkpoint-file run.ckp -f gun.rle
+./life -e bit -c 1000000 -g 1000000 --checkpoint-every 100000 --checkpoint-file run.ckp --resume run.ckp
+On a torus, where gliders leaving one edge come back in at the opposite one:
+./life -e simd --wrap -s 20 -c 100 -i 010000000001000000000010000000010000000011100000000100000000
+Keeping the grids in memory from the hugetlbfs pool rather than transparent huge
+pages (the default; --huge-pages off for neither), all faulted in up front:
+./life -e simd --huge-pages hugetlb --prefault -s 16384 -c 100 -f gosper_glider_gun.rle > /dev/null
+Sharing 32 threads out over the NUMA nodes, with each band of rows kept in the
+memory of the node whose thread computes it:
+./life -e bit -t 32 --numa -s 65536 -c 100 -f gosper_glider_gun.rle > /dev/null
+Writing the population, births, deaths and bounding box of every generation to
+life.stats, as the bit and simd engines count them while they step:
+./life -e bit -s 4096 -c 1000 --stats life.stats -f gosper_glider_gun.rle > /dev/null
+Counting cycles, instructions, cache and branch misses and page faults while
+generations are computed, for the whole run and for every 100 generations (on stderr):
+./life -e bit -s 4096 -c 1000 --counters-band 100 -f gosper_glider_gun.rle > /dev/null
 Bee-hive and loaf:
 ./life -s 10 -c 100 -i 010000000001000000000010000000010000000011100000000100000000 > life.out
 */
 
 #include <assert.h>
+#include <errno.h>
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <unistd.h>
 
+#include "batch.h"
+#include "bench.h"
+#include "checkpoint.h"
+#include "counters.h"
+#include "cycle.h"
+#include "engine.h"
+#include "output.h"
+#include "pattern.h"
+#include "pool.h"
+#include "stats.h"
+
+/* Generations kept in memory at once. step() only ever reads the generation
+   before the one it writes, so a ring of two buffers is enough however many
+   cycles are run: generation n lives in slot n % HISTORY_DEPTH. */
+#define HISTORY_DEPTH 2
+
+/* Each generation is stored with a one cell dead border around it, so it takes
+   (size + 2) * (size + 2) chars and cell (x, y) sits at row y + 1, column
+   x + 1. step() can then read the neighbours of any cell without edge tests,
+   and the border cells, never written, give the dead-edge semantics. */
 char *world_history = NULL;
 
+// The rule, as rule_mask() gives it, that step() applies.
+uint32_t rule_mask_bits = 0;
+
+/* With --wrap the border is not dead but a copy of the opposite edge, the
+   halo, which wrap_row() refreshes whenever the cells it copies change. */
+bool wrap_edges = false;
+
+unsigned long
+padded_size (const unsigned long size)
+{
+  return size + 2;
+}
+
+char *
+generation (const unsigned long size, const unsigned long step_number)
+{
+  return world_history + padded_size(size) * padded_size(size) * (step_number % HISTORY_DEPTH);
+}
+
 void
-init_step (const unsigned long size, const char *init_world)
+init_step (const struct engine *engine, void *world, const unsigned long size, const char *init_world)
 {
-  bool completely_uninitialized = false;
   unsigned long init_size = 0;
   if (NULL != init_world)
     init_size = strlen(init_world);
-  else
-    completely_uninitialized = true;
 
-  for (unsigned long i = 0; i < size * size; i++) {
-    if (completely_uninitialized || i >= init_size) {
-      world_history[i] = 0;
-      continue;
-    }
+  char *row = malloc(size);
+  for (unsigned long y = 0; y < size; y++) {
+    // Cells past the end of init_world are dead.
+    const unsigned long start = y * size;
+    const unsigned long given = start >= init_size ? 0 : (init_size - start < size ? init_size - start : size);
+    memset(row + given, 0, size - given);
 
-    if (0 == strncmp("0", init_world + i, 1)) {
-      world_history[i] = 0;
-    } else if (0 == strncmp("1", init_world + i, 1)) {
-      world_history[i] = 1;
-    } else if (0 == strncmp("\0", init_world + i, 1)) {
-      return;
-    } else {
-      fprintf(stderr, "Invalid initial state"); // FIXME: show the offending character.
-      exit(EXIT_FAILURE);
+    // Only rows with cells given are scanned: past the end, or without -i, init_world + start points nowhere.
+    if (given > 0) {
+      const unsigned long bad = scan_cells(init_world + start, given, row, '1', '0');
+      if (bad < given) {
+        fprintf(stderr, "Invalid initial state: '%c' at position %lu\n", init_world[start + bad], start + bad + 1);
+        exit(EXIT_FAILURE);
+      }
     }
+    engine->load_row(world, y, row);
   }
+  free(row);
 }
 
 char
@@ -72,7 +174,7 @@ get_value (const unsigned long size, const unsigned long step_number, const unsi
   // FIXME assert y >= 0
   // FIXME assert x < size
   // FIXME assert y < size
-  return world_history[size * size * step_number + y * size + x];
+  return generation(size, step_number)[(y + 1) * padded_size(size) + x + 1];
 }
 
 void
@@ -82,175 +184,553 @@ set_value (const unsigned long size, const unsigned long step_number, const unsi
   // FIXME assert y >= 0
   // FIXME assert x < size
   // FIXME assert y < size
-  world_history[size * size * step_number + y * size + x] = value;
+  generation(size, step_number)[(y + 1) * padded_size(size) + x + 1] = value;
 }
 
-char
-neighbour_state (const unsigned long size, const unsigned long step_number, const unsigned long x, const unsigned long y, const unsigned char neighbour_offset)
+// Computes rows [begin, end) of generation step_number.
+void
+step_rows (const unsigned long size, const unsigned long step_number, const unsigned long begin, const unsigned long end)
 {
-  /* Numberings of the neighbours of the cell labeled "C":
-        _ _ _
-       |0|1|2|
-       |-|-|-|
-       |3|C|4|
-       |-|-|-|
-       |5|6|7|
-        - - -
-  */
-  char result = -2;
-
-  switch (neighbour_offset) {
-    case 0:
-      if (0 == x || 0 == y) {
-        result = -1;
-      } else {
-        result = get_value(size, step_number, x - 1, y - 1);
-      }
-      break;
-    case 1:
-      if (0 == y) {
-        result = -1;
-      } else {
-        result = get_value(size, step_number, x, y - 1);
-      }
-      break;
-    case 2:
-      if (size - 1 == x || 0 == y) {
-        result = -1;
-      } else {
-        result = get_value(size, step_number, x + 1, y - 1);
-      }
-      break;
-    case 3:
-      if (0 == x) {
-        result = -1;
-      } else {
-        result = get_value(size, step_number, x - 1, y);
-      }
-      break;
-    case 4:
-      if (size - 1 == x) {
-        result = -1;
-      } else {
-        result = get_value(size, step_number, x + 1, y);
-      }
-      break;
-    case 5:
-      if (0 == x || size - 1 == y) {
-        result = -1;
-      } else {
-        result = get_value(size, step_number, x - 1, y + 1);
-      }
-      break;
-    case 6:
-      if (size - 1 == y) {
-        result = -1;
-      } else {
-        result = get_value(size, step_number, x, y + 1);
-      }
-      break;
-    case 7:
-      if (size - 1 == x || size - 1 == y) {
-        result = -1;
-      } else {
-        result = get_value(size, step_number, x + 1, y + 1);
-      }
-      break;
-    default:
-      // FIXME terminate with error message.
-      break;
-  }
+  const unsigned long stride = padded_size(size);
+  const char *previous = generation(size, step_number - 1);
+  char *next = generation(size, step_number);
 
-  return result;
-}
+  for (unsigned long y = begin + 1; y <= end; y++) {
+    const char *up = previous + (y - 1) * stride;
+    const char *mid = up + stride;
+    const char *down = mid + stride;
 
-unsigned char
-living_neighbours (const unsigned long size, const unsigned long step_number, const unsigned long x, const unsigned long y)
-{
-  // FIXME assert x >= 0
-  // FIXME assert y >= 0
-  // FIXME assert x < size
-  // FIXME assert y < size
-  unsigned char result = 0;
+    /* Sums of the three cells in the columns left of, through and right of
+       the current cell. Moving one cell right reuses two of them, so each
+       cell costs three loads for the new right-hand column. */
+    unsigned char left = (unsigned char)(up[0] + mid[0] + down[0]);
+    unsigned char centre = (unsigned char)(up[1] + mid[1] + down[1]);
 
-  for (unsigned char i = 0; i < 8; i++) {
-    if (1 == neighbour_state(size, step_number, x, y, i)) {
-      result += 1;
+    for (unsigned long x = 1; x <= size; x++) {
+      const unsigned char right = (unsigned char)(up[x + 1] + mid[x + 1] + down[x + 1]);
+      const char state = mid[x];
+      const unsigned char ln = (unsigned char)(left + centre + right - state);
+      next[y * stride + x] = rule_next(rule_mask_bits, state, ln);
+      left = centre;
+      centre = right;
     }
   }
+}
 
-  return result;
+/* Refreshes the halo of generation step_number around row y: the border cells
+   at both ends of the row and, for the top and bottom rows, the border row on
+   the opposite side. */
+void
+wrap_row (const unsigned long size, const unsigned long step_number, const unsigned long y)
+{
+  const unsigned long stride = padded_size(size);
+  char *cells = generation(size, step_number);
+  char *row = cells + (y + 1) * stride;
+  row[0] = row[size];
+  row[size + 1] = row[1];
+  if (0 == y)
+    memcpy(cells + (size + 1) * stride, row, stride);
+  if (size - 1 == y)
+    memcpy(cells, row, stride);
+}
+
+// Refreshes the whole halo of generation step_number.
+void
+wrap (const unsigned long size, const unsigned long step_number)
+{
+  for (unsigned long y = 0; y < size; y++)
+    wrap_row(size, step_number, y);
 }
 
 void
 step (const unsigned long size, const unsigned long step_number)
 {
-  for (unsigned long y = 0; y < size; y++) {
-    for (unsigned long x = 0; x < size; x++) {
-      const unsigned char ln = living_neighbours(size, step_number - 1, x, y);
-      char state = get_value(size, step_number - 1, x, y);
-      if (1 == state) {
-        if (ln < 2) {
-          state = 0;
-        } else if (2 == ln || 3 == ln) {
-          state = 1;
-        } else if (ln > 3) {
-          state = 0;
-        }
-      } else if (0 == state) {
-        if (3 == ln) {
-          state = 1;
-        }
-      }
+  step_rows(size, step_number, 0, size);
+  if (wrap_edges)
+    wrap(size, step_number);
+}
 
-      set_value(size, step_number, x, y, state);
-    }
+/* The byte engine: the original one char per cell in world_history, reached
+   through get_value() and set_value() and advanced by step(). */
+struct byte_world {
+  unsigned long size;
+  unsigned long step_number;
+  // Holds world_history.
+  struct arena *arena;
+};
+
+static void *
+byte_create (const struct life_config *config)
+{
+  assert(NULL == world_history); // world_history is global, so one world at a time.
+  struct byte_world *world = malloc(sizeof(*world));
+  world->size = config->size;
+  world->step_number = 0;
+  rule_mask_bits = rule_mask(&config->rule);
+  wrap_edges = config->wrap;
+
+  const unsigned long cells = padded_size(config->size) * padded_size(config->size) * HISTORY_DEPTH;
+  world->arena = arena_create(&config->arena, arena_bytes(cells));
+  world_history = arena_alloc(world->arena, cells, HISTORY_DEPTH);
+  return world;
+}
+
+static void
+byte_load_row (void *state, const unsigned long y, const char *row)
+{
+  const struct byte_world *world = state;
+  for (unsigned long x = 0; x < world->size; x++)
+    set_value(world->size, world->step_number, x, y, row[x]);
+  if (wrap_edges)
+    wrap_row(world->size, world->step_number, y);
+}
+
+static void
+byte_read_row (const void *state, const unsigned long y, char *row)
+{
+  const struct byte_world *world = state;
+  for (unsigned long x = 0; x < world->size; x++)
+    row[x] = get_value(world->size, world->step_number, x, y);
+}
+
+static void
+byte_step (void *state)
+{
+  struct byte_world *world = state;
+  world->step_number++;
+  step(world->size, world->step_number);
+}
+
+static void
+byte_step_rows (void *state, const unsigned long begin, const unsigned long end)
+{
+  const struct byte_world *world = state;
+  step_rows(world->size, world->step_number + 1, begin, end);
+}
+
+static void
+byte_commit (void *state)
+{
+  struct byte_world *world = state;
+  world->step_number++;
+  if (wrap_edges)
+    wrap(world->size, world->step_number);
+}
+
+static void
+byte_destroy (void *state)
+{
+  struct byte_world *world = state;
+  arena_destroy(world->arena);
+  world_history = NULL;
+  free(world);
+}
+
+const struct engine byte_engine = {
+  .name = "byte",
+  .create = byte_create,
+  .load_row = byte_load_row,
+  .read_row = byte_read_row,
+  .step = byte_step,
+  .step_rows = byte_step_rows,
+  .commit = byte_commit,
+  .destroy = byte_destroy,
+};
+
+const struct engine *const engines[] = {
+  &byte_engine,
+  &bit_engine,
+  &simd_engine,
+  &tile_engine,
+  &hash_engine,
+  &sparse_engine,
+  &block_engine,
+  &lut_engine,
+  &mmap_engine,
+};
+const unsigned long engine_count = sizeof(engines) / sizeof(engines[0]);
+
+const struct engine *
+find_engine (const char *name)
+{
+  for (unsigned long i = 0; i < engine_count; i++) {
+    if (0 == strcmp(engines[i]->name, name))
+      return engines[i];
   }
+  return NULL;
 }
 
+struct band_job {
+  const struct engine *engine;
+  void *world;
+  unsigned long size;
+};
+
+// Pool job computing this thread's band of rows of the next generation.
+static void
+step_band (void *arg, const unsigned long thread, const unsigned long threads)
+{
+  const struct band_job *job = arg;
+  job->engine->step_rows(job->world, job->size * thread / threads, job->size * (thread + 1) / threads);
+}
+
+/* Advances world by one generation, splitting the rows into one band per
+   thread of pool if there is a pool. */
 void
-print_world (const unsigned long size, const unsigned long step_number)
+step_world (const struct engine *engine, void *world, const unsigned long size, struct pool *pool)
 {
-/*
-  for (int y = 0; y < size; y++) {
-    for (int x = 0; x < size; x++) {
-      int v = get_value(size, step_number, x, y);
-      printf("%d", v);
-    }
-    printf("\n");
+  if (NULL == pool) {
+    engine->step(world);
+    return;
   }
-*/
-  for (unsigned long y = 0; y < size; y++) {
-    for (unsigned long x = 0; x < size; x++) {
-      char v = get_value(size, step_number, x, y);
-      char terminator[1] = "";
-      if (x < size - 1)
-        terminator[0] = ',';
-      printf("%d%s", v, terminator);
+
+  struct band_job job = { .engine = engine, .world = world, .size = size };
+  pool_run(pool, step_band, &job);
+  engine->commit(world);
+}
+
+void
+advance_world (const struct engine *engine, void *world, const unsigned long size, struct pool *pool,
+               const unsigned long generations)
+{
+  if (NULL != engine->advance && NULL == pool) {
+    engine->advance(world, generations);
+    return;
+  }
+
+  for (unsigned long i = 0; i < generations; i++)
+    step_world(engine, world, size, pool);
+}
+
+/* Brings world from generation generation forward to generation target, and
+   returns the generation it got to. If cycle is not NULL, every generation on
+   the way is shown to it, and the world is left where it is once the rest can
+   be replayed from cycle. If stats is not NULL, every generation on the way
+   is recorded in it. If counters is not NULL, they count the computing. */
+unsigned long
+run_world (const struct engine *engine, void *world, const unsigned long size, struct pool *pool,
+           struct cycle *cycle, struct stats *stats, struct counters *counters, unsigned long generation,
+           const unsigned long target)
+{
+  if (NULL == cycle && NULL == stats) {
+    if (NULL != counters)
+      counters_start(counters);
+    advance_world(engine, world, size, pool, target - generation);
+    if (NULL != counters)
+      counters_stop(counters, target);
+    return target;
+  }
+
+  while (generation < target && (NULL == cycle || !cycle_replaying(cycle))) {
+    if (NULL != counters)
+      counters_start(counters);
+    step_world(engine, world, size, pool);
+    generation++;
+    if (NULL != counters)
+      counters_stop(counters, generation);
+    if (NULL != stats)
+      stats_record(stats, engine, world, generation);
+    if (NULL != cycle && cycle_record(cycle, engine, world, generation))
+      fprintf(stderr, "Generation %lu repeats generation %lu: period %lu\n", cycle_repeat(cycle),
+              cycle_repeat(cycle) - cycle_period(cycle), cycle_period(cycle));
+  }
+  return generation;
+}
+
+static int
+compare_generations (const void *a, const void *b)
+{
+  const unsigned long x = *(const unsigned long *)a;
+  const unsigned long y = *(const unsigned long *)b;
+  return (x > y) - (x < y);
+}
+
+/* Parses the comma-separated list of generations given to -g into a sorted
+   array of count generations. */
+unsigned long *
+parse_generations (const char *list, unsigned long *count)
+{
+  unsigned long *generations = NULL;
+  *count = 0;
+
+  const char *cursor = list;
+  while (true) {
+    char *end = NULL;
+    // strtoul() gives ULONG_MAX for a number too big for it, and only says so in errno.
+    errno = 0;
+    const unsigned long generation = strtoul(cursor, &end, 10);
+    if (end == cursor || (',' != *end && '\0' != *end) || ERANGE == errno) {
+      fprintf(stderr, "Invalid list of generations: %s\n", list);
+      exit(EXIT_FAILURE);
     }
-    printf(" ");
+    generations = realloc(generations, (*count + 1) * sizeof(unsigned long));
+    generations[(*count)++] = generation;
+    if ('\0' == *end)
+      break;
+    cursor = end + 1;
   }
+
+  qsort(generations, *count, sizeof(unsigned long), compare_generations);
+  return generations;
 }
 
+// Options that only have a long name.
+enum {
+  OPTION_PIN = 256,
+  OPTION_HASH_MEM,
+  OPTION_BLOCK_DEPTH,
+  OPTION_MMAP_DIR,
+  OPTION_FORMAT,
+  OPTION_KEYFRAME_EVERY,
+  OPTION_OUTPUT_QUEUE,
+  OPTION_DETECT_CYCLES,
+  OPTION_EARLY_EXIT,
+  OPTION_BENCH,
+  OPTION_BENCH_SIZES,
+  OPTION_BENCH_DENSITIES,
+  OPTION_BENCH_GENERATIONS,
+  OPTION_BENCH_REPEAT,
+  OPTION_BENCH_WARMUP,
+  OPTION_BENCH_FORMAT,
+  OPTION_COUNTERS,
+  OPTION_COUNTERS_BAND,
+  OPTION_WRAP,
+  OPTION_BATCH,
+  OPTION_CHECKPOINT_EVERY,
+  OPTION_CHECKPOINT_FILE,
+  OPTION_RESUME,
+  OPTION_HUGE_PAGES,
+  OPTION_PREFAULT,
+  OPTION_NUMA,
+  OPTION_STATS,
+};
+
+static const struct option long_options[] = {
+  {"size", required_argument, NULL, 's'},
+  {"init", required_argument, NULL, 'i'},
+  {"file", required_argument, NULL, 'f'},
+  {"cycles", required_argument, NULL, 'c'},
+  {"engine", required_argument, NULL, 'e'},
+  {"threads", required_argument, NULL, 't'},
+  {"generations", required_argument, NULL, 'g'},
+  {"rule", required_argument, NULL, 'r'},
+  {"pin", no_argument, NULL, OPTION_PIN},
+  {"hash-mem", required_argument, NULL, OPTION_HASH_MEM},
+  {"block-depth", required_argument, NULL, OPTION_BLOCK_DEPTH},
+  {"mmap-dir", required_argument, NULL, OPTION_MMAP_DIR},
+  {"format", required_argument, NULL, OPTION_FORMAT},
+  {"keyframe-every", required_argument, NULL, OPTION_KEYFRAME_EVERY},
+  {"output-queue", required_argument, NULL, OPTION_OUTPUT_QUEUE},
+  {"detect-cycles", no_argument, NULL, OPTION_DETECT_CYCLES},
+  {"early-exit", no_argument, NULL, OPTION_EARLY_EXIT},
+  {"bench", no_argument, NULL, OPTION_BENCH},
+  {"bench-sizes", required_argument, NULL, OPTION_BENCH_SIZES},
+  {"bench-densities", required_argument, NULL, OPTION_BENCH_DENSITIES},
+  {"bench-generations", required_argument, NULL, OPTION_BENCH_GENERATIONS},
+  {"bench-repeat", required_argument, NULL, OPTION_BENCH_REPEAT},
+  {"bench-warmup", required_argument, NULL, OPTION_BENCH_WARMUP},
+  {"bench-format", required_argument, NULL, OPTION_BENCH_FORMAT},
+  {"counters", no_argument, NULL, OPTION_COUNTERS},
+  {"counters-band", required_argument, NULL, OPTION_COUNTERS_BAND},
+  {"wrap", no_argument, NULL, OPTION_WRAP},
+  {"batch", required_argument, NULL, OPTION_BATCH},
+  {"checkpoint-every", required_argument, NULL, OPTION_CHECKPOINT_EVERY},
+  {"checkpoint-file", required_argument, NULL, OPTION_CHECKPOINT_FILE},
+  {"resume", required_argument, NULL, OPTION_RESUME},
+  {"huge-pages", required_argument, NULL, OPTION_HUGE_PAGES},
+  {"prefault", no_argument, NULL, OPTION_PREFAULT},
+  {"numa", no_argument, NULL, OPTION_NUMA},
+  {"stats", required_argument, NULL, OPTION_STATS},
+  {NULL, 0, NULL, 0},
+};
+
 int
 main (int argc, char* const* argv)
 {
   unsigned long size = 3;
   char *init_world = NULL;
+  const char *pattern_file = NULL;
   unsigned long cycles = 3;
+  struct rule rule = RULE_CONWAY;
+  const struct engine *engine = &byte_engine;
+  unsigned long threads = 1;
+  bool pin = false;
+  unsigned long hash_memory = 1024;
+  unsigned long block_depth = 8;
+  const char *mmap_dir = ".";
+  enum huge_pages huge_pages = HUGE_PAGES_THP;
+  bool prefault = false;
+  bool numa = false;
+  const char *stats_file = NULL;
+  enum output_format format = FORMAT_TEXT;
+  unsigned long keyframe_every = 100;
+  // Generations that can wait for the output writer; 0 writes them before stepping on.
+  unsigned long output_queue = 4;
+  bool detect_cycles = false;
+  bool early_exit = false;
+  bool bench = false;
+  bool engine_given = false;
+  const char *bench_sizes = "64,256,1024";
+  const char *bench_densities = "0.1,0.3,0.5";
+  const char *bench_generations = "10,100";
+  unsigned long bench_repeat = 5;
+  unsigned long bench_warmup = 1;
+  bool bench_csv = false;
+  bool count = false;
+  unsigned long counters_band = 0;
+  bool wrap_world = false;
+  const char *batch_file = NULL;
+  unsigned long checkpoint_every = 0;
+  const char *checkpoint_file = NULL;
+  const char *resume_file = NULL;
+  // Whether -s and -r were given, to check them against --resume.
+  bool size_given = false;
+  bool rule_given = false;
+  // Generations to print, if not all of them.
+  unsigned long *report = NULL;
+  unsigned long report_count = 0;
 
   int option;
-  while ((option = getopt(argc, argv, "s:i:c:")) != -1) {
+  while ((option = getopt_long(argc, argv, "s:i:f:c:e:t:g:r:", long_options, NULL)) != -1) {
     switch (option) {
     case 'i':
       init_world = malloc(strlen(optarg) + 1);
       strcpy(init_world, optarg);
       break;
+    case 'f':
+      pattern_file = optarg;
+      break;
     case 's':
       size = strtoul(optarg, NULL, 10);
+      size_given = true;
       break;
     case 'c':
+      errno = 0;
       cycles = strtoul(optarg, NULL, 10);
+      if (ERANGE == errno) {
+        fprintf(stderr, "Invalid number of cycles: %s\n", optarg);
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'e':
+      engine = find_engine(optarg);
+      if (NULL == engine) {
+        fprintf(stderr, "Unknown engine: %s\n", optarg);
+        exit(EXIT_FAILURE);
+      }
+      engine_given = true;
+      break;
+    case 't':
+      threads = strtoul(optarg, NULL, 10);
+      break;
+    case 'g':
+      free(report);
+      report = parse_generations(optarg, &report_count);
+      break;
+    case 'r':
+      if (!rule_parse(optarg, &rule)) {
+        fprintf(stderr, "Unknown rule: %s\n", optarg);
+        exit(EXIT_FAILURE);
+      }
+      rule_given = true;
+      break;
+    case OPTION_PIN:
+      pin = true;
+      break;
+    case OPTION_HASH_MEM:
+      hash_memory = strtoul(optarg, NULL, 10);
+      break;
+    case OPTION_BLOCK_DEPTH:
+      block_depth = strtoul(optarg, NULL, 10);
+      if (0 == block_depth || block_depth > BLOCK_MAX_DEPTH) {
+        fprintf(stderr, "--block-depth must be from 1 to %d\n", BLOCK_MAX_DEPTH);
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case OPTION_MMAP_DIR:
+      mmap_dir = optarg;
+      break;
+    case OPTION_HUGE_PAGES:
+      if (!find_huge_pages(optarg, &huge_pages)) {
+        fprintf(stderr, "Unknown huge page setting: %s\n", optarg);
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case OPTION_PREFAULT:
+      prefault = true;
+      break;
+    case OPTION_NUMA:
+      numa = true;
+      break;
+    case OPTION_STATS:
+      stats_file = optarg;
+      break;
+    case OPTION_FORMAT:
+      if (!find_format(optarg, &format)) {
+        fprintf(stderr, "Unknown output format: %s\n", optarg);
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case OPTION_KEYFRAME_EVERY:
+      keyframe_every = strtoul(optarg, NULL, 10);
+      break;
+    case OPTION_OUTPUT_QUEUE:
+      output_queue = strtoul(optarg, NULL, 10);
+      break;
+    case OPTION_DETECT_CYCLES:
+      detect_cycles = true;
+      break;
+    case OPTION_EARLY_EXIT:
+      detect_cycles = true;
+      early_exit = true;
+      break;
+    case OPTION_BENCH:
+      bench = true;
+      break;
+    case OPTION_BENCH_SIZES:
+      bench_sizes = optarg;
+      break;
+    case OPTION_BENCH_DENSITIES:
+      bench_densities = optarg;
+      break;
+    case OPTION_BENCH_GENERATIONS:
+      bench_generations = optarg;
+      break;
+    case OPTION_BENCH_REPEAT:
+      bench_repeat = strtoul(optarg, NULL, 10);
+      break;
+    case OPTION_BENCH_WARMUP:
+      bench_warmup = strtoul(optarg, NULL, 10);
+      break;
+    case OPTION_BENCH_FORMAT:
+      if (0 == strcmp("csv", optarg)) {
+        bench_csv = true;
+      } else if (0 != strcmp("json", optarg)) {
+        fprintf(stderr, "Unknown benchmark format: %s\n", optarg);
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case OPTION_COUNTERS:
+      count = true;
+      break;
+    case OPTION_COUNTERS_BAND:
+      count = true;
+      counters_band = strtoul(optarg, NULL, 10);
+      break;
+    case OPTION_WRAP:
+      wrap_world = true;
+      break;
+    case OPTION_BATCH:
+      batch_file = optarg;
+      break;
+    case OPTION_CHECKPOINT_EVERY:
+      checkpoint_every = strtoul(optarg, NULL, 10);
+      break;
+    case OPTION_CHECKPOINT_FILE:
+      checkpoint_file = optarg;
+      break;
+    case OPTION_RESUME:
+      resume_file = optarg;
       break;
     default:
       // FIXME: print error message.
@@ -259,27 +739,239 @@ main (int argc, char* const* argv)
     }
   }
 
+  // The world comes from the checkpoint, as does everything that shapes it.
+  struct checkpoint_header resumed = { .generation = 0 };
+  if (NULL != resume_file) {
+    checkpoint_read_header(resume_file, &resumed);
+    if (NULL != init_world || NULL != pattern_file) {
+      fprintf(stderr, "--resume cannot be used with -i or -f\n");
+      exit(EXIT_FAILURE);
+    }
+    if ((size_given && size != resumed.size) || (rule_given && !rule_equal(&rule, &resumed.rule))
+        || (wrap_world && !resumed.wrap)) {
+      fprintf(stderr, "-s, -r or --wrap differ from what %s was checkpointed with\n", resume_file);
+      exit(EXIT_FAILURE);
+    }
+    size = resumed.size;
+    rule = resumed.rule;
+    wrap_world = resumed.wrap;
+  }
+
+  if ((0 == checkpoint_every) != (NULL == checkpoint_file)) {
+    fprintf(stderr, "--checkpoint-every and --checkpoint-file go together\n");
+    exit(EXIT_FAILURE);
+  }
+
   assert(size > 1);
   assert(cycles > 1);
+  assert(threads > 0);
+  assert(block_depth > 0);
+  assert(keyframe_every > 0);
+
+  if (NULL != init_world && NULL != pattern_file) {
+    fprintf(stderr, "-i and -f cannot be used together\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Batch mode reads its worlds from its own file and steps them itself.
+  if (NULL != batch_file && (NULL != init_world || NULL != pattern_file || engine_given || threads > 1
+                             || NULL != report || bench || NULL != checkpoint_file || NULL != resume_file)) {
+    fprintf(stderr, "--batch cannot be used with -i, -f, -e, -t, -g, --bench or checkpoints\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (NULL != stats_file && (NULL != batch_file || bench || early_exit)) {
+    fprintf(stderr, "--stats cannot be used with --batch, --bench or --early-exit\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (NULL != stats_file && engine->unbounded) {
+    fprintf(stderr, "The %s engine runs on an unbounded plane, so statistics of its window would miss cells\n",
+            engine->name);
+    exit(EXIT_FAILURE);
+  }
+
+  if (NULL != checkpoint_file && engine->unbounded) {
+    fprintf(stderr, "The %s engine runs on an unbounded plane, which a checkpoint of its window would lose\n",
+            engine->name);
+    exit(EXIT_FAILURE);
+  }
+
+  if (detect_cycles && engine->unbounded) {
+    fprintf(stderr, "The %s engine runs on an unbounded plane, so cycles cannot be told from its window\n",
+            engine->name);
+    exit(EXIT_FAILURE);
+  }
+
+  // B0 would bring the whole of an unbounded plane to life in one step.
+  if ((rule.birth & 1) && engine->unbounded) {
+    fprintf(stderr, "The %s engine runs on an unbounded plane, so it cannot run rules with B0\n", engine->name);
+    exit(EXIT_FAILURE);
+  }
+
+  if (wrap_world && engine->unbounded) {
+    fprintf(stderr, "The %s engine runs on an unbounded plane, which cannot wrap around\n", engine->name);
+    exit(EXIT_FAILURE);
+  }
+
+  // report is sorted, so its last generation is the furthest one.
+  const unsigned long last_generation = NULL != report ? report[report_count - 1] : cycles - 1;
+  if (0 != engine->max_generations && last_generation > engine->max_generations) {
+    fprintf(stderr, "The %s engine cannot go past generation %lu\n", engine->name, engine->max_generations);
+    exit(EXIT_FAILURE);
+  }
+
+  struct life_config config = {
+    .size = size,
+    .rule = rule,
+    .wrap = wrap_world,
+    .hash_memory = hash_memory,
+    .block_depth = block_depth,
+    .mmap_dir = mmap_dir,
+    .arena = {
+      .huge_pages = huge_pages,
+      .prefault = prefault,
+      // Bands as step_world() cuts them, one per thread.
+      .bands = threads,
+      // Set once the pool has placed its threads.
+      .band_nodes = NULL,
+    },
+    .stats = NULL != stats_file,
+  };
+
+  /* The output writer and the checkpoint writer start before the pool, which
+     pins this thread with --pin or --numa and would pass that on to them: they
+     are to run on any CPU the process has, not queue up behind thread 0. */
+  struct output *output = NULL;
+  struct checkpoint *checkpoint = NULL;
+  if (!bench && NULL == batch_file) {
+    // A queue would hold copies of the world in memory, which out-of-core engines are there to avoid.
+    output = output_create(STDOUT_FILENO, format, size, &rule, keyframe_every, engine->out_of_core ? 0 : output_queue);
+    if (NULL != checkpoint_file)
+      checkpoint = checkpoint_create(checkpoint_file, &config);
+  }
 
-  world_history = malloc(size * size * cycles);
+  struct pool *pool = NULL;
+  if (threads > 1) {
+    // The benchmark only uses the pool for the engines that can.
+    if (NULL == engine->step_rows && !bench) {
+      fprintf(stderr, "The %s engine cannot run on several threads\n", engine->name);
+      exit(EXIT_FAILURE);
+    }
+    pool = pool_create(threads, pin, numa);
+    config.arena.band_nodes = pool_nodes(pool);
+  }
 
-  for (unsigned long i = 0; i < size * size * cycles; i++) {
-    world_history[i] = 0;
+  /* One thread steps without a pool, but still goes where --pin and --numa
+     would put the first thread of one: placing a pool of one does that. */
+  int lone_node;
+  if (1 == threads && (pin || numa)) {
+    struct pool *placed = pool_create(1, pin, numa);
+    if (NULL != pool_nodes(placed)) {
+      lone_node = pool_nodes(placed)[0];
+      config.arena.band_nodes = &lone_node;
+    }
+    pool_destroy(placed);
+  }
+
+  if (bench) {
+    assert(bench_repeat > 0);
+    struct bench_config bench_config = {
+      .engine = engine_given ? engine : NULL,
+      .repetitions = bench_repeat,
+      .warmup = bench_warmup,
+      .csv = bench_csv,
+      .pool = pool,
+      .life = config,
+    };
+    unsigned long *sizes = parse_generations(bench_sizes, &bench_config.size_count);
+    double *densities = parse_densities(bench_densities, &bench_config.density_count);
+    unsigned long *generations = parse_generations(bench_generations, &bench_config.generation_count);
+    bench_config.sizes = sizes;
+    bench_config.densities = densities;
+    bench_config.generations = generations;
+
+    run_bench(&bench_config);
+
+    free(sizes);
+    free(densities);
+    free(generations);
+    if (NULL != pool)
+      pool_destroy(pool);
+    free(init_world);
+    free(report);
+    return EXIT_SUCCESS;
+  }
+  if (NULL != batch_file) {
+    run_batch(batch_file, &config, cycles - 1);
+    return EXIT_SUCCESS;
   }
 
-  init_step(size, init_world);
-  print_world(size, 0);
-  printf("\n");
+  void *world = engine->create(&config);
 
-  for (unsigned long i = 1; i < cycles; i++) {
-    step(size, i);
-    print_world(size, i);
-    printf("\n");
+  if (NULL != resume_file)
+    checkpoint_load(resume_file, engine, world);
+  else if (NULL != pattern_file)
+    load_pattern(engine, world, size, &rule, pattern_file);
+  else
+    init_step(engine, world, size, init_world);
+
+  struct counters *counters = NULL;
+  if (count)
+    counters = counters_create(pool, counters_band);
+
+  struct stats *stats = NULL;
+  if (NULL != stats_file) {
+    stats = stats_create(stats_file, size);
+    stats_record(stats, engine, world, resumed.generation);
+  }
+
+  struct cycle *cycle = NULL;
+  if (detect_cycles) {
+    cycle = cycle_create(size, early_exit);
+    cycle_record(cycle, engine, world, resumed.generation);
+  }
+
+  // Without -g, every generation up to the number of cycles is printed.
+  const unsigned long outputs = NULL != report ? report_count : cycles;
+  unsigned long generation = resumed.generation;
+  for (unsigned long i = 0; i < outputs; i++) {
+    const unsigned long target = NULL != report ? report[i] : i;
+    // Generations before the one resumed from are gone.
+    if (target < resumed.generation)
+      continue;
+
+    // Stop at every checkpoint on the way to target.
+    while (NULL != checkpoint && (generation / checkpoint_every + 1) * checkpoint_every <= target) {
+      const unsigned long due = (generation / checkpoint_every + 1) * checkpoint_every;
+      generation = run_world(engine, world, size, pool, cycle, stats, counters, generation, due);
+      if (generation < due)
+        break;
+      checkpoint_save(checkpoint, engine, world, generation);
+    }
+    generation = run_world(engine, world, size, pool, cycle, stats, counters, generation, target);
+    if (generation < target) {
+      cycle_seek(cycle, target);
+      output_world(output, &replay_engine, cycle, target);
+    } else {
+      output_world(output, engine, world, target);
+    }
   }
 
-  free(world_history);
+  output_destroy(output);
+  if (NULL != checkpoint)
+    checkpoint_destroy(checkpoint);
+  if (NULL != counters)
+    counters_destroy(counters);
+  if (NULL != cycle)
+    cycle_destroy(cycle);
+  if (NULL != stats)
+    stats_destroy(stats);
+  engine->destroy(world);
+  if (NULL != pool)
+    pool_destroy(pool);
   free(init_world);
+  free(report);
 
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,195 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Lookup-table engine: the world is stepped in 2x2 blocks. The 4x4 cells around
+a block are packed into a 16-bit key, and a 65536-entry table built for the
+rule when a world is created gives the block's next four cells. No neighbours are
+counted at step time.
+
+Key bit r * 4 + c holds the cell r - 1 rows below and c - 1 columns right of
+the block's top-left cell. Moving to the next block two columns right shifts
+every row of the key by two, so each block only loads its two new columns:
+two loads per cell.
+
+Cells are one char each. The grid has one dead row and column before the world
+and two after it, so blocks that stick out past an odd-sized world stay in
+bounds; whatever they write there is cleared again after each step. With
+--wrap those rows and columns are a halo copied from the opposite edges
+instead, refreshed after each step.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+
+// Next state of the 2x2 centre of each 4x4 neighbourhood, in bits 0-3.
+static uint8_t lut_table[1 << 16];
+// The rule_mask() that lut_table was built for; 0 until it is built.
+static uint32_t lut_rule = 0;
+
+struct lut_world {
+  unsigned long size;
+  // Bytes per row; cell (x, y) is at (y + 1) * stride + x + 1.
+  unsigned long stride;
+  bool wrap;
+  // Holds every grid below.
+  struct arena *arena;
+  char *current;
+  char *next;
+};
+
+static void
+lut_build (const uint32_t rule)
+{
+  for (unsigned long key = 0; key < (1 << 16); key++) {
+    uint8_t result = 0;
+    for (int cell = 0; cell < 4; cell++) {
+      const int r = 1 + cell / 2;
+      const int c = 1 + cell % 2;
+      int ln = 0;
+      for (int dr = -1; dr <= 1; dr++) {
+        for (int dc = -1; dc <= 1; dc++) {
+          if (0 != dr || 0 != dc)
+            ln += (int)((key >> ((r + dr) * 4 + c + dc)) & 1);
+        }
+      }
+      const int alive = (int)((key >> (r * 4 + c)) & 1);
+      result |= (uint8_t)(rule_next(rule, alive, ln) << cell);
+    }
+    lut_table[key] = result;
+  }
+  lut_rule = rule;
+}
+
+static void *
+lut_create (const struct life_config *config)
+{
+  const uint32_t rule = rule_mask(&config->rule);
+  if (rule != lut_rule)
+    lut_build(rule);
+
+  struct lut_world *world = malloc(sizeof(*world));
+  world->size = config->size;
+  world->stride = config->size + 3;
+  world->wrap = config->wrap;
+  const unsigned long grid = world->stride * world->stride;
+  world->arena = arena_create(&config->arena, 2 * arena_bytes(grid));
+  world->current = arena_alloc(world->arena, grid, 1);
+  world->next = arena_alloc(world->arena, grid, 1);
+  return world;
+}
+
+/* Refreshes the halo around row y of grid for --wrap: one column and row
+   before the world, and two after it. */
+static void
+lut_wrap_row (const struct lut_world *world, char *grid, const unsigned long y)
+{
+  const unsigned long size = world->size;
+  char *row = grid + (y + 1) * world->stride;
+  row[0] = row[size];
+  row[size + 1] = row[1];
+  row[size + 2] = row[2];
+  if (y < 2)
+    memcpy(grid + (size + 1 + y) * world->stride, row, world->stride);
+  if (size - 1 == y)
+    memcpy(grid, row, world->stride);
+}
+
+static void
+lut_load_row (void *state, const unsigned long y, const char *row)
+{
+  struct lut_world *world = state;
+  memcpy(world->current + (y + 1) * world->stride + 1, row, world->size);
+  if (world->wrap)
+    lut_wrap_row(world, world->current, y);
+}
+
+static void
+lut_read_row (const void *state, const unsigned long y, char *row)
+{
+  const struct lut_world *world = state;
+  memcpy(row, world->current + (y + 1) * world->stride + 1, world->size);
+}
+
+// Bits for a column of the four rows at rows, c columns into the key.
+static unsigned
+lut_column (const char *const rows[4], const unsigned long x, const int c)
+{
+  return ((unsigned)rows[0][x] << c) | ((unsigned)rows[1][x] << (4 + c)) | ((unsigned)rows[2][x] << (8 + c))
+         | ((unsigned)rows[3][x] << (12 + c));
+}
+
+static void
+lut_step (void *state)
+{
+  struct lut_world *world = state;
+  const unsigned long stride = world->stride;
+
+  for (unsigned long y = 1; y <= world->size; y += 2) {
+    const char *const rows[4] = { world->current + (y - 1) * stride, world->current + y * stride,
+                                  world->current + (y + 1) * stride, world->current + (y + 2) * stride };
+    char *top = world->next + y * stride;
+    char *bottom = top + stride;
+
+    // Columns x - 1 and x of the first block; the loop adds x + 1 and x + 2.
+    unsigned key = lut_column(rows, 0, 2) | lut_column(rows, 1, 3);
+    for (unsigned long x = 1; x <= world->size; x += 2) {
+      key = ((key >> 2) & 0x3333) | lut_column(rows, x + 1, 2) | lut_column(rows, x + 2, 3);
+      const uint8_t result = lut_table[key];
+      top[x] = (char)(result & 1);
+      top[x + 1] = (char)((result >> 1) & 1);
+      bottom[x] = (char)((result >> 2) & 1);
+      bottom[x + 1] = (char)((result >> 3) & 1);
+    }
+  }
+
+  // Odd-sized worlds: the last blocks wrote one column and row too far.
+  if (world->size % 2) {
+    for (unsigned long y = 1; y <= world->size; y++)
+      world->next[y * stride + world->size + 1] = 0;
+    memset(world->next + (world->size + 1) * stride, 0, stride);
+  }
+
+  char *tmp = world->current;
+  world->current = world->next;
+  world->next = tmp;
+  if (world->wrap) {
+    for (unsigned long y = 0; y < world->size; y++)
+      lut_wrap_row(world, world->current, y);
+  }
+}
+
+static void
+lut_destroy (void *state)
+{
+  struct lut_world *world = state;
+  arena_destroy(world->arena);
+  free(world);
+}
+
+const struct engine lut_engine = {
+  .name = "lut",
+  .create = lut_create,
+  .load_row = lut_load_row,
+  .read_row = lut_read_row,
+  .step = lut_step,
+  .destroy = lut_destroy,
+};
@@ -0,0 +1,239 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Out-of-core engine: the current and next generation are memory-mapped files
+in --mmap-dir rather than memory, one char per cell, so the world can be
+larger than RAM. The files are unlinked as soon as they are mapped and vanish
+when the program exits.
+
+A step streams through the files in order. It keeps a window of three padded
+rows in memory, reads each row of the current file once, and writes each row
+of the next file once. madvise() tells the kernel to read ahead of the window
+and to drop what is behind it, so the resident set stays a few chunks in size
+whatever the size of the world. With --wrap, the rows outside the world are
+the ones at the opposite edge, and so are the cells either side of each row in
+the window.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "engine.h"
+
+// Bytes of the files to read ahead of, and drop behind, the window at a time.
+#define MMAP_CHUNK (8UL << 20)
+
+struct mmap_world {
+  unsigned long size;
+  // Bytes in each file: size * size.
+  unsigned long length;
+  uint32_t rule;
+  bool wrap;
+  char *current;
+  char *next;
+};
+
+static char *
+mmap_file (const char *dir, const unsigned long length)
+{
+  const size_t path_length = strlen(dir) + sizeof("/life-XXXXXX");
+  char *path = malloc(path_length);
+  snprintf(path, path_length, "%s/life-XXXXXX", dir);
+
+  const int fd = mkstemp(path);
+  if (fd < 0) {
+    fprintf(stderr, "Could not create a world file in %s: %s\n", dir, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  unlink(path);
+  free(path);
+
+  if (0 != ftruncate(fd, (off_t)length)) {
+    fprintf(stderr, "Could not size a world file to %lu bytes: %s\n", length, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  char *map = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (MAP_FAILED == map) {
+    fprintf(stderr, "Could not map a world file: %s\n", strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  close(fd);
+
+  madvise(map, length, MADV_SEQUENTIAL);
+  return map;
+}
+
+// madvise() on the whole pages within [offset, offset + length) of map.
+static void
+mmap_advise (char *map, const unsigned long map_length, unsigned long offset, unsigned long length, const int advice)
+{
+  const unsigned long page = (unsigned long)sysconf(_SC_PAGESIZE);
+  if (offset >= map_length)
+    return;
+  if (offset + length > map_length)
+    length = map_length - offset;
+
+  const unsigned long start = (offset + page - 1) / page * page;
+  const unsigned long end = (offset + length) / page * page;
+  if (start < end)
+    madvise(map + start, end - start, advice);
+}
+
+static void *
+mmap_create (const struct life_config *config)
+{
+  struct mmap_world *world = malloc(sizeof(*world));
+  world->size = config->size;
+  world->length = config->size * config->size;
+  world->rule = rule_mask(&config->rule);
+  world->wrap = config->wrap;
+  world->current = mmap_file(config->mmap_dir, world->length);
+  world->next = mmap_file(config->mmap_dir, world->length);
+  return world;
+}
+
+static void
+mmap_load_row (void *state, const unsigned long y, const char *row)
+{
+  struct mmap_world *world = state;
+  memcpy(world->current + y * world->size, row, world->size);
+}
+
+static void
+mmap_read_row (const void *state, const unsigned long y, char *row)
+{
+  const struct mmap_world *world = state;
+  memcpy(row, world->current + y * world->size, world->size);
+}
+
+/* Copies row y of the current file, or the row that wraps around to y or a
+   dead row if y is outside the world. */
+static void
+mmap_fill (const struct mmap_world *world, const unsigned long y, char *padded)
+{
+  const unsigned long size = world->size;
+  if (y < size) {
+    memcpy(padded + 1, world->current + y * size, size);
+  } else if (world->wrap) {
+    // y is -1 or size.
+    memcpy(padded + 1, world->current + (size == y ? 0 : size - 1) * size, size);
+  } else {
+    memset(padded + 1, 0, size);
+  }
+
+  if (world->wrap) {
+    padded[0] = padded[size];
+    padded[size + 1] = padded[1];
+  }
+}
+
+static void
+mmap_step_rows (void *state, const unsigned long begin, const unsigned long end)
+{
+  struct mmap_world *world = state;
+  const unsigned long size = world->size;
+
+  // The three rows around the one being computed, each with a dead cell at both ends.
+  char *window = calloc(3 * (size + 2), 1);
+  char *up = window;
+  char *mid = up + size + 2;
+  char *down = mid + size + 2;
+  mmap_fill(world, begin - 1, up);
+  mmap_fill(world, begin, mid);
+
+  unsigned long advised = begin * size;
+  for (unsigned long y = begin; y < end; y++) {
+    mmap_fill(world, y + 1, down);
+
+    char *out = world->next + y * size;
+    int left = up[0] + mid[0] + down[0];
+    int centre = up[1] + mid[1] + down[1];
+    for (unsigned long x = 1; x <= size; x++) {
+      const int right = up[x + 1] + mid[x + 1] + down[x + 1];
+      const int ln = left + centre + right - mid[x];
+      out[x - 1] = rule_next(world->rule, mid[x], ln);
+      left = centre;
+      centre = right;
+    }
+
+    /* Every chunk: ask for the next one and let go of the one just done.
+       The mappings are shared, so dropped pages are still in the page cache
+       or the file and come back if another band reads them. */
+    const unsigned long done = (y + 1) * size;
+    if (done >= advised + MMAP_CHUNK || y + 1 == end) {
+      mmap_advise(world->current, world->length, done + size, MMAP_CHUNK, MADV_WILLNEED);
+      mmap_advise(world->current, world->length, advised, done - advised, MADV_DONTNEED);
+      mmap_advise(world->next, world->length, advised, done - advised, MADV_DONTNEED);
+      advised = done;
+    }
+
+    char *tmp = up;
+    up = mid;
+    mid = down;
+    down = tmp;
+  }
+
+  free(window);
+}
+
+static void
+mmap_commit (void *state)
+{
+  struct mmap_world *world = state;
+  char *tmp = world->current;
+  world->current = world->next;
+  world->next = tmp;
+}
+
+static void
+mmap_step (void *state)
+{
+  struct mmap_world *world = state;
+  mmap_step_rows(world, 0, world->size);
+  mmap_commit(world);
+}
+
+static void
+mmap_destroy (void *state)
+{
+  struct mmap_world *world = state;
+  munmap(world->current, world->length);
+  munmap(world->next, world->length);
+  free(world);
+}
+
+const struct engine mmap_engine = {
+  .name = "mmap",
+  .out_of_core = true,
+  .create = mmap_create,
+  .load_row = mmap_load_row,
+  .read_row = mmap_read_row,
+  .step = mmap_step,
+  .step_rows = mmap_step_rows,
+  .commit = mmap_commit,
+  .destroy = mmap_destroy,
+};
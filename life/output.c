@@ -0,0 +1,560 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Output formats for --format. Every format is built up a whole row at a time
+in one buffer of at least OUTPUT_BUFFER bytes, which goes out in a single
+write() each time it is about to overflow and when the output is destroyed.
+Rows are formatted with plain loops over the row that read_row() returns:
+text puts a digit and a separator per cell, binary has the engine write
+straight into the buffer, and PBM packs eight cells per byte.
+
+The delta format is for long runs of mostly still worlds. It writes a keyframe,
+which is the generation in RLE exactly as --format=rle has it, after a line
+"K <generation>". Later generations are written as the cells that flipped
+since the one before, after a line "D <generation>": one line per row with
+any flips, "<y> <x> <x>-<x> ...", where a-b stands for columns a to b. Every
+--keyframe-every generations there is a new keyframe, so a reader can start
+from the nearest one instead of from the beginning. To find the flips, each
+row is packed 64 cells to a word and XORed with the same row of the previous
+generation, kept packed as well, so unchanged stretches cost a word compare.
+
+With a queue (--output-queue), formatting and writing happen on a writer
+thread instead. output_world() only packs the generation, eight cells to a
+byte, into the next free slot of a ring and goes back to stepping; the writer
+takes slots in order, formats each one from the packed cells exactly as above
+and writes it out. So the run only waits for output when the writer is a
+whole queue behind, and takes as long as the slower of the two rather than
+their sum. For small worlds, handing over every generation on its own would
+cost more than formatting it, so the ring also gets as many more slots as fit
+in OUTPUT_BUFFER bytes, and the writer is only woken once those are full and
+then empties the ring: as without a queue, output goes out about a buffer at
+a time. The slots of the queue all come out of OUTPUT_QUEUE_BYTES, so it is
+shorter than asked for with big worlds, and not there at all once a single
+generation is bigger than that.
+*/
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "output.h"
+#include "pattern.h"
+
+#define OUTPUT_BUFFER (1UL << 20)
+// The most that the queue's packed generations may take up.
+#define OUTPUT_QUEUE_BYTES (64UL << 20)
+// Lines of RLE are kept to at most this many characters.
+#define RLE_LINE 70
+
+static const char *const format_names[] = {
+  [FORMAT_TEXT] = "text",
+  [FORMAT_BINARY] = "binary",
+  [FORMAT_RLE] = "rle",
+  [FORMAT_PBM] = "pbm",
+  [FORMAT_DELTA] = "delta",
+};
+
+// A generation in the queue: size rows of row_bytes bytes, packed by pack_cells().
+struct output_snapshot {
+  unsigned long size;
+  unsigned long row_bytes;
+  const unsigned char *cells;
+};
+
+struct output {
+  int fd;
+  enum output_format format;
+  unsigned long size;
+  char rule[RULE_TEXT];
+  char *buffer;
+  unsigned long capacity;
+  unsigned long used;
+  // A row of cells, as read_row() returns it.
+  char *row;
+  // Characters on the current line of RLE.
+  unsigned long line;
+  // For deltas: the last generation written, packed, words words to a row.
+  uint64_t *previous;
+  unsigned long words;
+  // A row packed for comparison with previous.
+  uint64_t *packed;
+  unsigned long keyframe_every;
+  // Generation of the last keyframe, if keyframed is set.
+  unsigned long keyframe;
+  bool keyframed;
+
+  // The queue; with queue_depth 0 there is none and nothing below is used.
+  unsigned long queue_depth;
+  // Slots in the ring: queue_depth, plus the ones that fit in OUTPUT_BUFFER.
+  unsigned long slots;
+  // The writer is woken once this many slots are queued: the ones added to queue_depth, plus one.
+  unsigned long batch;
+  // Bytes of a packed generation, and slots of them.
+  unsigned long slot_bytes;
+  unsigned char *cells;
+  unsigned long *generations;
+  // A row as the engine's read_row() gives it, for packing into a slot.
+  char *staging;
+  // The oldest queued slot, and how many are queued from there on.
+  unsigned long head;
+  unsigned long queued;
+  pthread_t writer;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  // Set to have the writer exit once the queue is empty.
+  bool stop;
+};
+
+static void
+snapshot_read_row (const void *state, const unsigned long y, char *row)
+{
+  const struct output_snapshot *snapshot = state;
+  unpack_cells(snapshot->cells + y * snapshot->row_bytes, snapshot->size, row);
+}
+
+// Reads the generation in an output_snapshot.
+static const struct engine snapshot_engine = {
+  .name = "snapshot",
+  .read_row = snapshot_read_row,
+};
+
+static void format_world (struct output *output, const struct engine *engine, const void *world,
+                          const unsigned long generation);
+static void output_flush (struct output *output);
+
+static void *
+output_writer (void *data)
+{
+  struct output *output = data;
+
+  struct output_snapshot snapshot = {
+    .size = output->size,
+    .row_bytes = (output->size + 7) / 8,
+  };
+
+  pthread_mutex_lock(&output->lock);
+  while (true) {
+    while (output->queued < output->batch && !output->stop)
+      pthread_cond_wait(&output->changed, &output->lock);
+    if (0 == output->queued)
+      break;
+
+    // Empty the ring. A slot stays queued while it is formatted, so that it is not packed over.
+    while (output->queued > 0) {
+      const unsigned long slot = output->head;
+      pthread_mutex_unlock(&output->lock);
+      snapshot.cells = output->cells + slot * output->slot_bytes;
+      format_world(output, &snapshot_engine, &snapshot, output->generations[slot]);
+      pthread_mutex_lock(&output->lock);
+      output->head = (output->head + 1) % output->slots;
+      output->queued--;
+      // output_world() waits for room only when the ring is full; let it go on once it is under queue_depth.
+      if (output->queued + 1 == output->queue_depth)
+        pthread_cond_broadcast(&output->changed);
+    }
+  }
+  pthread_mutex_unlock(&output->lock);
+  return NULL;
+}
+
+bool
+find_format (const char *name, enum output_format *format)
+{
+  for (unsigned long i = 0; i < sizeof(format_names) / sizeof(format_names[0]); i++) {
+    if (0 == strcmp(format_names[i], name)) {
+      *format = (enum output_format)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+struct output *
+output_create (const int fd, const enum output_format format, const unsigned long size, const struct rule *rule,
+               const unsigned long keyframe_every, const unsigned long queue_depth)
+{
+  struct output *output = malloc(sizeof(*output));
+  output->fd = fd;
+  output->format = format;
+  output->size = size;
+  rule_format(rule, output->rule);
+  // Room for at least one formatted row, at two chars per cell at most.
+  output->capacity = OUTPUT_BUFFER > 2 * size + 64 ? OUTPUT_BUFFER : 2 * size + 64;
+  output->buffer = malloc(output->capacity);
+  output->used = 0;
+  output->row = malloc(size);
+  output->line = 0;
+
+  output->previous = NULL;
+  output->packed = NULL;
+  output->words = (size + 63) / 64;
+  if (FORMAT_DELTA == format) {
+    output->previous = malloc(size * output->words * sizeof(uint64_t));
+    output->packed = malloc(output->words * sizeof(uint64_t));
+  }
+  output->keyframe_every = keyframe_every;
+  output->keyframe = 0;
+  output->keyframed = false;
+
+  /* Every slot holds a whole generation, so the queue is kept to
+     OUTPUT_QUEUE_BYTES; a world too big for a single slot gets no queue. */
+  output->slot_bytes = size * ((size + 7) / 8);
+  const unsigned long fits = OUTPUT_QUEUE_BYTES / output->slot_bytes;
+  output->queue_depth = queue_depth < fits ? queue_depth : fits;
+  output->cells = NULL;
+  output->generations = NULL;
+  output->staging = NULL;
+  if (0 == output->queue_depth)
+    return output;
+
+  const unsigned long extra = OUTPUT_BUFFER / (output->slot_bytes + sizeof(unsigned long));
+  output->slots = output->queue_depth + extra;
+  output->batch = extra + 1;
+  output->cells = malloc(output->slots * output->slot_bytes);
+  output->generations = malloc(output->slots * sizeof(unsigned long));
+  output->staging = malloc(size);
+  output->head = 0;
+  output->queued = 0;
+  output->stop = false;
+  pthread_mutex_init(&output->lock, NULL);
+  pthread_cond_init(&output->changed, NULL);
+  if (0 != pthread_create(&output->writer, NULL, output_writer, output)) {
+    fprintf(stderr, "Could not start the output writer\n");
+    exit(EXIT_FAILURE);
+  }
+  return output;
+}
+
+static void
+output_flush (struct output *output)
+{
+  unsigned long written = 0;
+  while (written < output->used) {
+    const ssize_t done = write(output->fd, output->buffer + written, output->used - written);
+    if (done < 0 && EINTR == errno)
+      continue;
+    if (done < 0) {
+      fprintf(stderr, "Could not write the output: %s\n", strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+    written += (unsigned long)done;
+  }
+  output->used = 0;
+}
+
+// Makes room for length more bytes in the buffer, and returns where they go.
+static char *
+output_reserve (struct output *output, const unsigned long length)
+{
+  if (output->used + length > output->capacity)
+    output_flush(output);
+  return output->buffer + output->used;
+}
+
+static void
+output_append (struct output *output, const char *text, const unsigned long length)
+{
+  memcpy(output_reserve(output, length), text, length);
+  output->used += length;
+}
+
+static void
+text_world (struct output *output, const struct engine *engine, const void *world)
+{
+  const unsigned long size = output->size;
+  for (unsigned long y = 0; y < size; y++) {
+    engine->read_row(world, y, output->row);
+    char *out = output_reserve(output, 2 * size);
+    for (unsigned long x = 0; x < size; x++) {
+      out[2 * x] = (char)('0' + output->row[x]);
+      out[2 * x + 1] = ',';
+    }
+    out[2 * size - 1] = ' ';
+    output->used += 2 * size;
+  }
+  output_append(output, "\n", 1);
+}
+
+static void
+binary_world (struct output *output, const struct engine *engine, const void *world)
+{
+  for (unsigned long y = 0; y < output->size; y++) {
+    engine->read_row(world, y, output_reserve(output, output->size));
+    output->used += output->size;
+  }
+}
+
+static void
+pbm_world (struct output *output, const struct engine *engine, const void *world)
+{
+  const unsigned long size = output->size;
+  const unsigned long bytes = (size + 7) / 8;
+  char header[64];
+  const int length = snprintf(header, sizeof(header), "P4\n%lu %lu\n", size, size);
+  output_append(output, header, (unsigned long)length);
+
+  for (unsigned long y = 0; y < size; y++) {
+    engine->read_row(world, y, output->row);
+    unsigned char *out = (unsigned char *)output_reserve(output, bytes);
+    memset(out, 0, bytes);
+    // The first cell of a byte is its most significant bit.
+    for (unsigned long x = 0; x < size; x++)
+      out[x / 8] = (unsigned char)(out[x / 8] | (unsigned char)output->row[x] << (7 - x % 8));
+    output->used += bytes;
+  }
+}
+
+// Writes the digits of number so that they end just before end; returns where they start.
+static char *
+format_number (char *end, unsigned long number)
+{
+  do {
+    *--end = (char)('0' + number % 10);
+    number /= 10;
+  } while (number > 0);
+  return end;
+}
+
+// Packs output->row into words, 64 cells to a word.
+static void
+pack_row (const struct output *output, uint64_t *words)
+{
+  memset(words, 0, output->words * sizeof(uint64_t));
+  for (unsigned long x = 0; x < output->size; x++)
+    words[x / 64] |= (uint64_t)(unsigned char)output->row[x] << (x % 64);
+}
+
+// Appends an RLE item: count (left out if 1) and tag, starting a new line if need be.
+static void
+rle_item (struct output *output, const unsigned long count, const char tag)
+{
+  char item[24];
+  char *start = item + sizeof(item) - 1;
+  *start = tag;
+  if (count > 1)
+    start = format_number(start, count);
+  const unsigned long length = (unsigned long)(item + sizeof(item) - start);
+
+  if (output->line + length > RLE_LINE) {
+    output_append(output, "\n", 1);
+    output->line = 0;
+  }
+  output_append(output, start, length);
+  output->line += length;
+}
+
+static void
+rle_world (struct output *output, const struct engine *engine, const void *world, const unsigned long generation)
+{
+  const unsigned long size = output->size;
+  char header[128];
+  const int length = snprintf(header, sizeof(header), "#C generation %lu\nx = %lu, y = %lu, rule = %s\n",
+                              generation, size, size, output->rule);
+  output_append(output, header, (unsigned long)length);
+  output->line = 0;
+
+  // Ends of rows not written out yet: they go in front of the next run of live cells.
+  unsigned long rows = 0;
+  for (unsigned long y = 0; y < size; y++) {
+    engine->read_row(world, y, output->row);
+    const char *row = output->row;
+    // A keyframe of the delta format: remember it to compare the next generation with.
+    if (NULL != output->previous)
+      pack_row(output, output->previous + y * output->words);
+
+    unsigned long x = 0;
+    while (x < size) {
+      const char *next = memchr(row + x, 1, size - x);
+      if (NULL == next)
+        break;
+      const unsigned long start = (unsigned long)(next - row);
+      unsigned long end = start + 1;
+      while (end < size && row[end])
+        end++;
+
+      if (rows > 0)
+        rle_item(output, rows, '$');
+      rows = 0;
+      if (start > x)
+        rle_item(output, start - x, 'b');
+      rle_item(output, end - start, 'o');
+      x = end;
+    }
+    // Dead cells at the end of a row are left out.
+    rows++;
+  }
+  // The ! is wrapped onto a line of its own like any other item once the last one is full.
+  rle_item(output, 1, '!');
+  output_append(output, "\n", 1);
+}
+
+// Appends separator, if it is not NUL, then number.
+static void
+delta_item (struct output *output, const char separator, const unsigned long number)
+{
+  char item[24];
+  char *start = format_number(item + sizeof(item), number);
+  if ('\0' != separator)
+    *--start = separator;
+  output_append(output, start, (unsigned long)(item + sizeof(item) - start));
+}
+
+// Appends the run of flipped cells from first to last.
+static void
+delta_run (struct output *output, const unsigned long first, const unsigned long last)
+{
+  delta_item(output, ' ', first);
+  if (last > first)
+    delta_item(output, '-', last);
+}
+
+static void
+delta_world (struct output *output, const struct engine *engine, const void *world, const unsigned long generation)
+{
+  char header[32];
+  if (!output->keyframed || generation - output->keyframe >= output->keyframe_every) {
+    const int length = snprintf(header, sizeof(header), "K %lu\n", generation);
+    output_append(output, header, (unsigned long)length);
+    rle_world(output, engine, world, generation);
+    output->keyframe = generation;
+    output->keyframed = true;
+    return;
+  }
+
+  const int length = snprintf(header, sizeof(header), "D %lu\n", generation);
+  output_append(output, header, (unsigned long)length);
+
+  for (unsigned long y = 0; y < output->size; y++) {
+    engine->read_row(world, y, output->row);
+    uint64_t *previous = output->previous + y * output->words;
+    pack_row(output, output->packed);
+
+    // Runs of flipped cells, from first to last, one run at a time.
+    bool flipped = false;
+    unsigned long first = 0;
+    unsigned long last = 0;
+    for (unsigned long w = 0; w < output->words; w++) {
+      uint64_t flips = output->packed[w] ^ previous[w];
+      previous[w] = output->packed[w];
+      while (0 != flips) {
+        const unsigned long x = w * 64 + (unsigned long)__builtin_ctzll(flips);
+        flips &= flips - 1;
+        if (flipped && x == last + 1) {
+          last = x;
+          continue;
+        }
+        if (!flipped)
+          delta_item(output, '\0', y);
+        else
+          delta_run(output, first, last);
+        flipped = true;
+        first = x;
+        last = x;
+      }
+    }
+    if (flipped) {
+      delta_run(output, first, last);
+      output_append(output, "\n", 1);
+    }
+  }
+}
+
+static void
+format_world (struct output *output, const struct engine *engine, const void *world, const unsigned long generation)
+{
+  switch (output->format) {
+  case FORMAT_TEXT:
+    text_world(output, engine, world);
+    break;
+  case FORMAT_BINARY:
+    binary_world(output, engine, world);
+    break;
+  case FORMAT_RLE:
+    rle_world(output, engine, world, generation);
+    break;
+  case FORMAT_PBM:
+    pbm_world(output, engine, world);
+    break;
+  case FORMAT_DELTA:
+    delta_world(output, engine, world, generation);
+    break;
+  default:
+    assert(false);
+    break;
+  }
+}
+
+void
+output_world (struct output *output, const struct engine *engine, const void *world, const unsigned long generation)
+{
+  if (0 == output->queue_depth) {
+    format_world(output, engine, world, generation);
+    return;
+  }
+
+  pthread_mutex_lock(&output->lock);
+  while (output->queued == output->slots)
+    pthread_cond_wait(&output->changed, &output->lock);
+  const unsigned long slot = (output->head + output->queued) % output->slots;
+  pthread_mutex_unlock(&output->lock);
+
+  // Only this thread adds to the queue, so the slot stays free while it is packed.
+  const unsigned long row_bytes = (output->size + 7) / 8;
+  unsigned char *cells = output->cells + slot * output->slot_bytes;
+  for (unsigned long y = 0; y < output->size; y++) {
+    engine->read_row(world, y, output->staging);
+    pack_cells(output->staging, output->size, cells + y * row_bytes);
+  }
+  output->generations[slot] = generation;
+
+  pthread_mutex_lock(&output->lock);
+  output->queued++;
+  // The writer waits for batch slots, and once it has them empties the ring before it waits again.
+  if (output->queued == output->batch)
+    pthread_cond_broadcast(&output->changed);
+  pthread_mutex_unlock(&output->lock);
+}
+
+void
+output_destroy (struct output *output)
+{
+  if (output->queue_depth > 0) {
+    pthread_mutex_lock(&output->lock);
+    output->stop = true;
+    pthread_cond_broadcast(&output->changed);
+    pthread_mutex_unlock(&output->lock);
+    pthread_join(output->writer, NULL);
+
+    pthread_mutex_destroy(&output->lock);
+    pthread_cond_destroy(&output->changed);
+    free(output->cells);
+    free(output->generations);
+    free(output->staging);
+  }
+  output_flush(output);
+  free(output->buffer);
+  free(output->row);
+  free(output->previous);
+  free(output->packed);
+  free(output);
+}
@@ -0,0 +1,65 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIFE_OUTPUT_H
+#define __LIFE_OUTPUT_H
+
+#include <stdbool.h>
+
+#include "engine.h"
+
+// What --format can ask for.
+enum output_format {
+  // The original format: "0,1,0 " per row and a line per generation.
+  FORMAT_TEXT,
+  // size * size bytes per generation, each 0 or 1, row by row.
+  FORMAT_BINARY,
+  // One RLE pattern per generation, as read by -f.
+  FORMAT_RLE,
+  // One raw PBM (P4) image per generation, live cells black.
+  FORMAT_PBM,
+  // Keyframes in RLE, and the cells that flipped in between.
+  FORMAT_DELTA,
+};
+
+/* Formats generations into a large buffer that is written out with write()
+   whenever it fills up, rather than a call into stdio per cell; with a queue,
+   on a thread of its own. */
+struct output;
+
+// Looks a --format name up; returns false if there is no such format.
+bool find_format (const char *name, enum output_format *format);
+
+/* keyframe_every is the most generations between keyframes of the delta
+   format, and is not used by the others. rule goes in the headers of RLE
+   patterns. Up to queue_depth generations wait to be formatted and written
+   by a writer thread while the caller steps on, as many as fit in the
+   queue's memory budget; with 0, or when not even one does, output_world()
+   does it all before it returns. */
+struct output *output_create (const int fd, const enum output_format format, const unsigned long size,
+                              const struct rule *rule, const unsigned long keyframe_every,
+                              const unsigned long queue_depth);
+/* Writes out the current generation of world, which is generation number
+   generation; with a queue, it is only copied before this returns. */
+void output_world (struct output *output, const struct engine *engine, const void *world,
+                   const unsigned long generation);
+// Flushes, then frees the output; fd stays open.
+void output_destroy (struct output *output);
+
+/* __LIFE_OUTPUT_H */
+#endif
@@ -0,0 +1,332 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Pattern files for -f. Two formats are read:
+
+  RLE, as written by Golly and most pattern collections: # comment lines, a
+  header line "x = <width>, y = <height>[, rule = ...]", then runs such as
+  "3o2b$" -- a count (1 if left out) followed by b (dead), o (alive) or $ (end
+  of row), with ! ending the pattern. Other letters are the states of
+  multi-state rules and are read as alive. The rule in the header does not
+  change the rule that is run (-r does), but a warning says if they differ.
+
+  Plaintext (.cells): ! comment lines, then one line per row with . for a dead
+  cell and O for a live one. Short lines and missing rows are dead.
+
+Regular files are mapped rather than read, so nothing is copied before it is
+decoded; stdin and pipes are read into a buffer. Rows are decoded into a row
+buffer and handed to the engine's load_row(): runs of RLE become memset()s and
+plaintext lines go through scan_cells(), whose loop the compiler vectorises,
+so a pattern costs about one pass over its text.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pattern.h"
+
+void
+pack_cells (const char *row, const unsigned long size, unsigned char *out)
+{
+  unsigned long x = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  for (; x + 8 <= size; x += 8) {
+    uint64_t cells;
+    memcpy(&cells, row + x, sizeof(cells));
+    /* Cell x + i is bit 8 * i of cells. The products of the multiply never
+       overlap, so it gathers bit 8 * i into bit 56 + i without carries. */
+    out[x / 8] = (unsigned char)((cells * 0x0102040810204080ULL) >> 56);
+  }
+#endif
+  if (x < size)
+    memset(out + x / 8, 0, (size - x + 7) / 8);
+  for (; x < size; x++)
+    out[x / 8] = (unsigned char)(out[x / 8] | (unsigned char)row[x] << (x % 8));
+}
+
+void
+unpack_cells (const unsigned char *in, const unsigned long size, char *row)
+{
+  unsigned long x = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  for (; x + 8 <= size; x += 8) {
+    // Spreads bit i of the byte out to bit 8 * i, halving the distance each time.
+    uint64_t cells = in[x / 8];
+    cells = (cells | cells << 28) & 0x0000000f0000000fULL;
+    cells = (cells | cells << 14) & 0x0003000300030003ULL;
+    cells = (cells | cells << 7) & 0x0101010101010101ULL;
+    memcpy(row + x, &cells, sizeof(cells));
+  }
+#endif
+  for (; x < size; x++)
+    row[x] = (char)((in[x / 8] >> (x % 8)) & 1);
+}
+
+// Size of the first buffer that stdin is read into; it doubles as needed.
+#define PATTERN_BUFFER (64UL << 10)
+
+unsigned long
+scan_cells (const char *text, const unsigned long length, char *row, const char alive, const char dead)
+{
+  /* No branches in this loop, so that it is compiled to vector compares. The
+     offending character is only looked for once we know there is one. */
+  unsigned char invalid = 0;
+  for (unsigned long x = 0; x < length; x++) {
+    const unsigned char is_alive = alive == text[x];
+    const unsigned char is_dead = dead == text[x];
+    row[x] = (char)is_alive;
+    invalid |= (unsigned char)(1 ^ (is_alive | is_dead));
+  }
+  if (!invalid)
+    return length;
+
+  for (unsigned long x = 0; x < length; x++) {
+    if (alive != text[x] && dead != text[x])
+      return x;
+  }
+  return length;
+}
+
+struct pattern_text {
+  const char *path;
+  char *text;
+  unsigned long length;
+  // Whether text is a mapping of the file, rather than a malloc()ed copy.
+  bool mapped;
+};
+
+static void
+pattern_fail (const char *path, const char *message)
+{
+  fprintf(stderr, "Could not read the pattern in %s: %s\n", path, message);
+  exit(EXIT_FAILURE);
+}
+
+static void
+pattern_read (struct pattern_text *input, const int fd)
+{
+  unsigned long capacity = PATTERN_BUFFER;
+  input->text = malloc(capacity);
+  input->length = 0;
+  input->mapped = false;
+
+  while (1) {
+    if (input->length == capacity) {
+      capacity *= 2;
+      input->text = realloc(input->text, capacity);
+    }
+    const ssize_t got = read(fd, input->text + input->length, capacity - input->length);
+    if (got < 0 && EINTR == errno)
+      continue;
+    if (got < 0)
+      pattern_fail(input->path, strerror(errno));
+    if (0 == got)
+      break;
+    input->length += (unsigned long)got;
+  }
+}
+
+static void
+pattern_open (struct pattern_text *input, const char *path)
+{
+  input->path = path;
+  if (0 == strcmp("-", path)) {
+    input->path = "stdin";
+    pattern_read(input, STDIN_FILENO);
+    return;
+  }
+
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    pattern_fail(path, strerror(errno));
+
+  struct stat status;
+  if (0 == fstat(fd, &status) && S_ISREG(status.st_mode) && status.st_size > 0) {
+    input->length = (unsigned long)status.st_size;
+    input->text = mmap(NULL, input->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED != input->text) {
+      input->mapped = true;
+      madvise(input->text, input->length, MADV_SEQUENTIAL);
+      close(fd);
+      return;
+    }
+  }
+
+  // Not something that can be mapped, such as a FIFO.
+  pattern_read(input, fd);
+  close(fd);
+}
+
+static void
+pattern_close (struct pattern_text *input)
+{
+  if (input->mapped)
+    munmap(input->text, input->length);
+  else
+    free(input->text);
+}
+
+// Length of the line starting at text, without its line break.
+static unsigned long
+line_length (const char *text, const unsigned long left)
+{
+  const char *newline = memchr(text, '\n', left);
+  return NULL == newline ? left : (unsigned long)(newline - text);
+}
+
+static void
+load_cells (const struct engine *engine, void *world, const unsigned long size, const struct pattern_text *input,
+            unsigned long offset, char *row)
+{
+  unsigned long y = 0;
+  unsigned long line = 1;
+  for (; offset < input->length && y < size; line++) {
+    const char *text = input->text + offset;
+    unsigned long length = line_length(text, input->length - offset);
+    offset += length + 1;
+
+    if (length > 0 && '!' == text[0])
+      continue;
+    if (length > 0 && '\r' == text[length - 1])
+      length--;
+
+    // Cells past the edge of the world are dropped without being looked at.
+    const unsigned long width = length < size ? length : size;
+    memset(row + width, 0, size - width);
+    const unsigned long bad = scan_cells(text, width, row, 'O', '.');
+    if (bad < width) {
+      fprintf(stderr, "Invalid character '%c' on line %lu, column %lu of %s\n", text[bad], line, bad + 1,
+              input->path);
+      exit(EXIT_FAILURE);
+    }
+    engine->load_row(world, y++, row);
+  }
+}
+
+/* Warns if the RLE header line at header, length characters long, names a
+   rule other than rule. Patterns with no rule in the header are Conway's. */
+static void
+check_rle_rule (const char *header, const unsigned long length, const struct rule *rule, const char *path)
+{
+  struct rule wanted = RULE_CONWAY;
+  char text[64] = "B3/S23";
+  for (unsigned long i = 0; i + 4 <= length; i++) {
+    if (0 != strncmp(header + i, "rule", 4))
+      continue;
+    unsigned long start = i + 4;
+    while (start < length && (' ' == header[start] || '=' == header[start]))
+      start++;
+    unsigned long end = start;
+    while (end < length && end - start < sizeof(text) - 1 && NULL == strchr(", \r", header[end]))
+      end++;
+    memcpy(text, header + start, end - start);
+    text[end - start] = '\0';
+    if (!rule_parse(text, &wanted)) {
+      fprintf(stderr, "Warning: %s is for rule %s, which is not understood\n", path, text);
+      return;
+    }
+    break;
+  }
+
+  if (!rule_equal(&wanted, rule)) {
+    char given[RULE_TEXT];
+    rule_format(rule, given);
+    fprintf(stderr, "Warning: %s is for rule %s, but it is being run under %s\n", path, text, given);
+  }
+}
+
+static void
+load_rle (const struct engine *engine, void *world, const unsigned long size, const struct rule *rule,
+          const struct pattern_text *input, unsigned long offset, char *row)
+{
+  const unsigned long header = line_length(input->text + offset, input->length - offset);
+  check_rle_rule(input->text + offset, header, rule, input->path);
+  offset += header + 1;
+
+  unsigned long x = 0;
+  unsigned long y = 0;
+  unsigned long count = 0;
+  bool ended = false;
+  memset(row, 0, size);
+  for (; offset < input->length && y < size && !ended; offset++) {
+    const char c = input->text[offset];
+    if (c >= '0' && c <= '9') {
+      // Counts larger than the world make no difference, so they saturate.
+      if (count < ULONG_MAX / 10)
+        count = count * 10 + (unsigned long)(c - '0');
+      continue;
+    }
+
+    const unsigned long run = 0 == count ? 1 : count;
+    count = 0;
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+      /* Dead runs are written too (row is all dead before they are), which
+         spares a hard-to-predict branch between b and o on noisy patterns. */
+      const unsigned long end = run < size - x ? x + run : size;
+      memset(row + x, 'b' != c, end - x);
+      x = end;
+    } else if ('$' == c || '!' == c) {
+      engine->load_row(world, y, row);
+      memset(row, 0, x);
+      x = 0;
+      // The rows skipped by a count are dead already.
+      y = run < size - y ? y + run : size;
+      ended = '!' == c;
+    } else if (' ' != c && '\t' != c && '\r' != c && '\n' != c) {
+      fprintf(stderr, "Invalid character '%c' at byte %lu of %s\n", c, offset + 1, input->path);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // A pattern cut off before its final !, or a last row that fell off the bottom.
+  if (!ended && y < size && x > 0)
+    engine->load_row(world, y, row);
+}
+
+void
+load_pattern (const struct engine *engine, void *world, const unsigned long size, const struct rule *rule,
+              const char *path)
+{
+  struct pattern_text input;
+  pattern_open(&input, path);
+
+  // RLE files start with # comment lines; plaintext ones use ! instead.
+  unsigned long offset = 0;
+  while (offset < input.length && '#' == input.text[offset])
+    offset += line_length(input.text + offset, input.length - offset) + 1;
+
+  char *row = malloc(size);
+  if (offset < input.length && 'x' == input.text[offset])
+    load_rle(engine, world, size, rule, &input, offset, row);
+  else
+    load_cells(engine, world, size, &input, offset, row);
+
+  free(row);
+  pattern_close(&input);
+}
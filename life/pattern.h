@@ -0,0 +1,43 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIFE_PATTERN_H
+#define __LIFE_PATTERN_H
+
+#include "engine.h"
+
+/* Converts length characters of text into row, one 0 or 1 per character, with
+   alive and dead the characters standing for live and dead cells. Returns the
+   offset of the first character that is neither, or length if they all are. */
+unsigned long scan_cells (const char *text, const unsigned long length, char *row, const char alive, const char dead);
+
+/* Packs size cells, each 0 or 1, into (size + 7) / 8 bytes, cell x in bit
+   x % 8 of byte x / 8; unpack_cells() does the opposite. */
+void pack_cells (const char *row, const unsigned long size, unsigned char *out);
+void unpack_cells (const unsigned char *in, const unsigned long size, char *row);
+
+/* Loads the pattern in the file at path ("-" for stdin) into the top-left
+   corner of world; cells outside the size x size world are dropped. The file
+   is in RLE if its first line that is not a # comment starts with "x", and in
+   plaintext (.cells) otherwise. A warning is printed if an RLE header names a
+   rule other than rule. */
+void load_pattern (const struct engine *engine, void *world, const unsigned long size, const struct rule *rule,
+                   const char *path);
+
+/* __LIFE_PATTERN_H */
+#endif
@@ -0,0 +1,275 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Persistent thread pool. Workers park on a barrier between jobs instead of
+being created and joined for each one: pool_run() publishes the job, meets the
+workers at the start barrier, runs its own share and meets them again at the
+finish barrier. A job therefore costs two barrier crossings.
+
+With numa set, the NUMA nodes that have CPUs this process may run on are read
+from sysfs, and the threads are shared out over them in order: thread i goes
+to node i * nodes / threads, so neighbouring threads, which compute
+neighbouring bands of rows, share a node. Each thread is bound to the CPUs of
+its node, or with pin to one of them.
+*/
+
+#define _GNU_SOURCE
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pool.h"
+
+#define POOL_NODE_DIR "/sys/devices/system/node"
+
+struct pool {
+  unsigned long threads;
+  pthread_t *workers;
+  pthread_barrier_t start;
+  pthread_barrier_t finish;
+  // The job being run; fn is NULL to tell the workers to exit.
+  pool_fn fn;
+  void *arg;
+  // The NUMA node of each thread, or NULL without numa.
+  int *nodes;
+};
+
+struct pool_node {
+  int id;
+  // The CPUs of the node that this process may run on.
+  cpu_set_t cpus;
+};
+
+struct worker {
+  struct pool *pool;
+  unsigned long thread;
+};
+
+static void *
+pool_worker (void *data)
+{
+  struct worker *worker = data;
+  struct pool *pool = worker->pool;
+  const unsigned long thread = worker->thread;
+  free(worker);
+
+  while (true) {
+    pthread_barrier_wait(&pool->start);
+    if (NULL == pool->fn)
+      break;
+    pool->fn(pool->arg, thread, pool->threads);
+    pthread_barrier_wait(&pool->finish);
+  }
+
+  return NULL;
+}
+
+// Binds thread to the (index % their number)-th CPU of allowed.
+static void
+pool_pin (const pthread_t thread, const unsigned long index, const cpu_set_t *allowed)
+{
+  const unsigned long cpus = (unsigned long)CPU_COUNT(allowed);
+  unsigned long wanted = index % cpus;
+  for (size_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (!CPU_ISSET(cpu, allowed))
+      continue;
+    if (0 == wanted) {
+      cpu_set_t one;
+      CPU_ZERO(&one);
+      CPU_SET(cpu, &one);
+      if (0 != pthread_setaffinity_np(thread, sizeof(one), &one))
+        fprintf(stderr, "Could not pin thread %lu to CPU %zu\n", index, cpu);
+      return;
+    }
+    wanted--;
+  }
+}
+
+// Reads a list of CPUs such as "0-3,8-11" from path into cpus.
+static bool
+pool_read_cpus (const char *path, cpu_set_t *cpus)
+{
+  FILE *file = fopen(path, "r");
+  if (NULL == file)
+    return false;
+
+  CPU_ZERO(cpus);
+  unsigned long first;
+  while (1 == fscanf(file, "%lu", &first)) {
+    unsigned long last = first;
+    int next = fgetc(file);
+    if ('-' == next) {
+      if (1 != fscanf(file, "%lu", &last))
+        break;
+      next = fgetc(file);
+    }
+    for (unsigned long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+      CPU_SET(cpu, cpus);
+    if (',' != next)
+      break;
+  }
+  fclose(file);
+  return true;
+}
+
+static int
+pool_compare_nodes (const void *a, const void *b)
+{
+  const struct pool_node *p = a;
+  const struct pool_node *q = b;
+  return (p->id > q->id) - (p->id < q->id);
+}
+
+// Finds the nodes with some of the CPUs in allowed, in order of id, and returns how many there are.
+static unsigned long
+pool_find_nodes (const cpu_set_t *allowed, struct pool_node **nodes)
+{
+  *nodes = NULL;
+  DIR *dir = opendir(POOL_NODE_DIR);
+  if (NULL == dir)
+    return 0;
+
+  unsigned long count = 0;
+  const struct dirent *entry;
+  while (NULL != (entry = readdir(dir))) {
+    int id;
+    char extra;
+    if (1 != sscanf(entry->d_name, "node%d%c", &id, &extra))
+      continue;
+
+    char path[64];
+    cpu_set_t cpus;
+    snprintf(path, sizeof(path), POOL_NODE_DIR "/node%d/cpulist", id);
+    if (!pool_read_cpus(path, &cpus))
+      continue;
+    CPU_AND(&cpus, &cpus, allowed);
+    if (0 == CPU_COUNT(&cpus))
+      continue;
+
+    *nodes = realloc(*nodes, (count + 1) * sizeof(struct pool_node));
+    (*nodes)[count].id = id;
+    (*nodes)[count].cpus = cpus;
+    count++;
+  }
+  closedir(dir);
+
+  qsort(*nodes, count, sizeof(struct pool_node), pool_compare_nodes);
+  return count;
+}
+
+// Shares the threads of pool out over the NUMA nodes, as described at the top.
+static void
+pool_place (struct pool *pool, const bool pin, const cpu_set_t *allowed)
+{
+  struct pool_node *nodes;
+  const unsigned long node_count = pool_find_nodes(allowed, &nodes);
+  if (0 == node_count) {
+    fprintf(stderr, "Found no NUMA nodes in %s to place threads on\n", POOL_NODE_DIR);
+    return;
+  }
+
+  pool->nodes = malloc(pool->threads * sizeof(int));
+  for (unsigned long i = 0; i < pool->threads; i++) {
+    const unsigned long node = i * node_count / pool->threads;
+    pool->nodes[i] = nodes[node].id;
+    if (pin) {
+      // Counting from the first thread on the node.
+      const unsigned long first = (node * pool->threads + node_count - 1) / node_count;
+      pool_pin(pool->workers[i], i - first, &nodes[node].cpus);
+    } else if (0 != pthread_setaffinity_np(pool->workers[i], sizeof(cpu_set_t), &nodes[node].cpus)) {
+      fprintf(stderr, "Could not bind thread %lu to NUMA node %d\n", i, nodes[node].id);
+    }
+  }
+  free(nodes);
+}
+
+struct pool *
+pool_create (const unsigned long threads, const bool pin, const bool numa)
+{
+  struct pool *pool = malloc(sizeof(*pool));
+  pool->threads = threads;
+  pool->fn = NULL;
+  pool->arg = NULL;
+  pool->workers = malloc(threads * sizeof(pthread_t));
+  pthread_barrier_init(&pool->start, NULL, (unsigned)threads);
+  pthread_barrier_init(&pool->finish, NULL, (unsigned)threads);
+
+  pool->workers[0] = pthread_self();
+  for (unsigned long i = 1; i < threads; i++) {
+    struct worker *worker = malloc(sizeof(*worker));
+    worker->pool = pool;
+    worker->thread = i;
+    if (0 != pthread_create(&pool->workers[i], NULL, pool_worker, worker)) {
+      fprintf(stderr, "Could not start thread %lu\n", i);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  pool->nodes = NULL;
+  cpu_set_t allowed;
+  if ((pin || numa) && 0 == sched_getaffinity(0, sizeof(allowed), &allowed)) {
+    if (numa)
+      pool_place(pool, pin, &allowed);
+    if (pin && NULL == pool->nodes) {
+      for (unsigned long i = 0; i < threads; i++)
+        pool_pin(pool->workers[i], i, &allowed);
+    }
+  }
+
+  return pool;
+}
+
+unsigned long
+pool_threads (const struct pool *pool)
+{
+  return pool->threads;
+}
+
+const int *
+pool_nodes (const struct pool *pool)
+{
+  return pool->nodes;
+}
+
+void
+pool_run (struct pool *pool, pool_fn fn, void *arg)
+{
+  pool->fn = fn;
+  pool->arg = arg;
+  pthread_barrier_wait(&pool->start);
+  fn(arg, 0, pool->threads);
+  pthread_barrier_wait(&pool->finish);
+}
+
+void
+pool_destroy (struct pool *pool)
+{
+  pool->fn = NULL;
+  pthread_barrier_wait(&pool->start);
+  for (unsigned long i = 1; i < pool->threads; i++)
+    pthread_join(pool->workers[i], NULL);
+
+  pthread_barrier_destroy(&pool->start);
+  pthread_barrier_destroy(&pool->finish);
+  free(pool->workers);
+  free(pool->nodes);
+  free(pool);
+}
@@ -0,0 +1,44 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIFE_POOL_H
+#define __LIFE_POOL_H
+
+#include <stdbool.h>
+
+/* A fixed set of threads that are started once and then handed one job at a
+   time, e.g. one job per generation. The thread calling pool_run() takes part
+   as thread 0, so a pool of n threads starts n - 1 of its own. */
+struct pool;
+
+// Work for one thread: thread is in [0, threads).
+typedef void (*pool_fn) (void *arg, const unsigned long thread, const unsigned long threads);
+
+/* With pin set, thread i is bound to the i-th CPU this process may run on.
+   With numa set, the threads are shared out over the NUMA nodes in order,
+   and each is bound to the CPUs of its node (with pin, to one of them). */
+struct pool *pool_create (const unsigned long threads, const bool pin, const bool numa);
+unsigned long pool_threads (const struct pool *pool);
+// The NUMA node of each thread, or NULL if the pool was not created with numa.
+const int *pool_nodes (const struct pool *pool);
+// Runs fn on every thread of the pool and returns once all of them finished.
+void pool_run (struct pool *pool, pool_fn fn, void *arg);
+void pool_destroy (struct pool *pool);
+
+/* __LIFE_POOL_H */
+#endif
@@ -0,0 +1,98 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Parsing and printing of -r rules. Both B/S notation (B36/S23) and the older
+S/B notation (23/36) are read; rules are printed in B/S notation.
+*/
+
+#include <ctype.h>
+#include <string.h>
+
+#include "rule.h"
+
+/* Reads the neighbour counts from text up to the next / or the end into
+   counts, and returns where it stopped, or NULL if there was something other
+   than a count. */
+static const char *
+rule_counts (const char *text, uint16_t *counts)
+{
+  *counts = 0;
+  for (; '\0' != *text && '/' != *text; text++) {
+    if (*text < '0' || *text > '8')
+      return NULL;
+    *counts = (uint16_t)(*counts | 1 << (*text - '0'));
+  }
+  return text;
+}
+
+bool
+rule_parse (const char *text, struct rule *rule)
+{
+  const char *slash = strchr(text, '/');
+  if (NULL == slash || NULL != strchr(slash + 1, '/'))
+    return false;
+
+  const char first = (char)toupper((unsigned char)text[0]);
+  const char second = (char)toupper((unsigned char)slash[1]);
+  uint16_t *before = NULL;
+  uint16_t *after = NULL;
+  if ('B' == first && 'S' == second) {
+    before = &rule->birth;
+    after = &rule->survival;
+  } else if ('S' == first && 'B' == second) {
+    before = &rule->survival;
+    after = &rule->birth;
+  } else if (!isalpha((unsigned char)first) && !isalpha((unsigned char)second)) {
+    // S/B: survival first, with no letters.
+    if (NULL == rule_counts(text, &rule->survival) || NULL == rule_counts(slash + 1, &rule->birth))
+      return false;
+    return true;
+  } else {
+    return false;
+  }
+
+  const char *end = rule_counts(text + 1, before);
+  if (end != slash)
+    return false;
+  end = rule_counts(slash + 2, after);
+  return NULL != end && '\0' == *end;
+}
+
+void
+rule_format (const struct rule *rule, char text[RULE_TEXT])
+{
+  char *out = text;
+  *out++ = 'B';
+  for (int n = 0; n <= 8; n++) {
+    if (rule->birth & 1 << n)
+      *out++ = (char)('0' + n);
+  }
+  *out++ = '/';
+  *out++ = 'S';
+  for (int n = 0; n <= 8; n++) {
+    if (rule->survival & 1 << n)
+      *out++ = (char)('0' + n);
+  }
+  *out = '\0';
+}
+
+bool
+rule_equal (const struct rule *a, const struct rule *b)
+{
+  return a->birth == b->birth && a->survival == b->survival;
+}
@@ -0,0 +1,87 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIFE_RULE_H
+#define __LIFE_RULE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* An outer-totalistic ("life-like") rule: whether a cell is alive next
+   depends only on whether it is alive now and how many of its eight
+   neighbours are. */
+struct rule {
+  // Bit n set: a dead cell with n live neighbours comes alive.
+  uint16_t birth;
+  // Bit n set: a live cell with n live neighbours stays alive.
+  uint16_t survival;
+};
+
+// Conway's rule, B3/S23.
+#define RULE_CONWAY ((struct rule){ .birth = 1 << 3, .survival = (1 << 2) | (1 << 3) })
+
+// Room needed by rule_format(), including the NUL.
+#define RULE_TEXT 24
+
+/* Parses a rule given as B3/S23 (either part first, in either case) or in
+   the older S/B form, 23/3. Returns false if text is neither. */
+bool rule_parse (const char *text, struct rule *rule);
+// Writes rule in B/S form.
+void rule_format (const struct rule *rule, char text[RULE_TEXT]);
+bool rule_equal (const struct rule *a, const struct rule *b);
+
+/* The rule as one mask for the kernels that work a cell at a time: bit
+   9 * alive + n says whether a cell that is alive (1) or dead (0) now, with n
+   live neighbours, is alive next. */
+static inline uint32_t
+rule_mask (const struct rule *rule)
+{
+  return (uint32_t)rule->birth | (uint32_t)rule->survival << 9;
+}
+
+static inline char
+rule_next (const uint32_t mask, const int alive, const int neighbours)
+{
+  return (char)((mask >> (9 * alive + neighbours)) & 1);
+}
+
+/* The rule applied to 64 cells at once, for the bit-sliced kernels: bit k of
+   bit0 to bit3 holds bits 0 to 3 of cell k's neighbour count, and bit k of
+   alive its state. The count is decoded, and the counts that the rule lets
+   live are kept. Always inlined, so that a constant rule is folded into the
+   caller. */
+static inline __attribute__((always_inline)) uint64_t
+rule_next_planes (const uint64_t bit0, const uint64_t bit1, const uint64_t bit2, const uint64_t bit3,
+                  const uint64_t alive, const unsigned birth, const unsigned survival)
+{
+  // The count decoded: low bits 0 to 3, high bits 0, 4 or 8.
+  const uint64_t low[4] = { ~bit1 & ~bit0, ~bit1 & bit0, bit1 & ~bit0, bit1 & bit0 };
+  const uint64_t high[3] = { ~(bit2 | bit3), bit2, bit3 };
+
+  uint64_t next = 0;
+  for (int count = 0; count <= 8; count++) {
+    // All ones or all zeros: whether this count gives birth, and survival.
+    const uint64_t born = -(uint64_t)((birth >> count) & 1);
+    const uint64_t stays = -(uint64_t)((survival >> count) & 1);
+    next |= low[count % 4] & high[count / 4] & ((born & ~alive) | (stays & alive));
+  }
+  return next;
+}
+
+/* __LIFE_RULE_H */
+#endif
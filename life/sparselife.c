@@ -0,0 +1,223 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Sparse engine: only the live cells are stored, as a list of coordinates on an
+unbounded plane, so a step costs time in proportion to the population rather
+than to size * size, and patterns can leave the -s window and come back.
+
+To step, every live cell adds one to the count of each of its eight neighbours
+in an open-addressing hash table and marks its own entry as alive. Only cells
+in that table can be alive next, so one pass over it gives the next
+generation.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+
+// Set in a table entry's value when the cell itself is alive.
+#define SPARSE_ALIVE 16
+#define SPARSE_MIN_SLOTS 1024UL
+
+struct cell {
+  int32_t x;
+  int32_t y;
+};
+
+struct sparse_entry {
+  uint64_t key;
+  // Live neighbours, plus SPARSE_ALIVE; 0 marks an empty slot.
+  uint8_t value;
+};
+
+struct sparse_world {
+  unsigned long size;
+  uint32_t rule;
+  // Kept ordered by row, then column, for read_row().
+  struct cell *cells;
+  unsigned long population;
+  unsigned long capacity;
+  struct sparse_entry *table;
+  unsigned long slots;
+};
+
+static uint64_t
+sparse_key (const int32_t x, const int32_t y)
+{
+  return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
+
+// Adds amount to the entry of cell (x, y), creating it if needed.
+static void
+sparse_add (struct sparse_world *world, const int32_t x, const int32_t y, const uint8_t amount)
+{
+  const uint64_t key = sparse_key(x, y);
+  const unsigned long mask = world->slots - 1;
+  unsigned long i = (unsigned long)((key * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+
+  while (0 != world->table[i].value && world->table[i].key != key)
+    i = (i + 1) & mask;
+  world->table[i].key = key;
+  world->table[i].value = (uint8_t)(world->table[i].value + amount);
+}
+
+static void
+sparse_append (struct sparse_world *world, const int32_t x, const int32_t y)
+{
+  if (world->population == world->capacity) {
+    world->capacity = world->capacity ? world->capacity * 2 : 64;
+    world->cells = realloc(world->cells, world->capacity * sizeof(struct cell));
+  }
+  world->cells[world->population].x = x;
+  world->cells[world->population].y = y;
+  world->population++;
+}
+
+static int
+sparse_compare (const void *a, const void *b)
+{
+  const struct cell *p = a;
+  const struct cell *q = b;
+  if (p->y != q->y)
+    return (p->y > q->y) - (p->y < q->y);
+  return (p->x > q->x) - (p->x < q->x);
+}
+
+static void *
+sparse_create (const struct life_config *config)
+{
+  struct sparse_world *world = calloc(1, sizeof(*world));
+  world->size = config->size;
+  world->rule = rule_mask(&config->rule);
+  return world;
+}
+
+static void
+sparse_load_row (void *state, const unsigned long y, const char *row)
+{
+  struct sparse_world *world = state;
+
+  /* Drop whatever was on this row before. Rows are normally loaded top to
+     bottom, below every live cell so far: then there is nothing to drop and
+     the list stays in order without being looked at. */
+  bool in_order = true;
+  if (world->population > 0 && world->cells[world->population - 1].y >= (int32_t)y) {
+    unsigned long kept = 0;
+    for (unsigned long i = 0; i < world->population; i++) {
+      if ((int32_t)y != world->cells[i].y)
+        world->cells[kept++] = world->cells[i];
+      if (world->cells[i].y > (int32_t)y)
+        in_order = false;
+    }
+    world->population = kept;
+  }
+
+  for (unsigned long x = 0; x < world->size; x++) {
+    if (row[x])
+      sparse_append(world, (int32_t)x, (int32_t)y);
+  }
+
+  if (!in_order)
+    qsort(world->cells, world->population, sizeof(struct cell), sparse_compare);
+}
+
+static void
+sparse_read_row (const void *state, const unsigned long y, char *row)
+{
+  const struct sparse_world *world = state;
+  memset(row, 0, world->size);
+
+  // Binary search for the first cell on row y.
+  unsigned long low = 0;
+  unsigned long high = world->population;
+  while (low < high) {
+    const unsigned long middle = low + (high - low) / 2;
+    if (world->cells[middle].y < (int32_t)y)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+
+  for (unsigned long i = low; i < world->population && world->cells[i].y == (int32_t)y; i++) {
+    if (world->cells[i].x >= 0 && (unsigned long)world->cells[i].x < world->size)
+      row[world->cells[i].x] = 1;
+  }
+}
+
+static void
+sparse_step (void *state)
+{
+  struct sparse_world *world = state;
+
+  // Every live cell touches at most nine entries; keep the table under half full.
+  unsigned long wanted = SPARSE_MIN_SLOTS;
+  while (wanted < world->population * 9 * 2)
+    wanted *= 2;
+  if (wanted != world->slots) {
+    free(world->table);
+    world->table = malloc(wanted * sizeof(struct sparse_entry));
+    world->slots = wanted;
+  }
+  memset(world->table, 0, world->slots * sizeof(struct sparse_entry));
+
+  for (unsigned long i = 0; i < world->population; i++) {
+    const int32_t x = world->cells[i].x;
+    const int32_t y = world->cells[i].y;
+    sparse_add(world, x, y, SPARSE_ALIVE);
+    sparse_add(world, x - 1, y - 1, 1);
+    sparse_add(world, x, y - 1, 1);
+    sparse_add(world, x + 1, y - 1, 1);
+    sparse_add(world, x - 1, y, 1);
+    sparse_add(world, x + 1, y, 1);
+    sparse_add(world, x - 1, y + 1, 1);
+    sparse_add(world, x, y + 1, 1);
+    sparse_add(world, x + 1, y + 1, 1);
+  }
+
+  world->population = 0;
+  for (unsigned long i = 0; i < world->slots; i++) {
+    const uint8_t value = world->table[i].value;
+    if (0 == value)
+      continue;
+    if (rule_next(world->rule, value >= SPARSE_ALIVE, value % SPARSE_ALIVE))
+      sparse_append(world, (int32_t)(world->table[i].key >> 32), (int32_t)(uint32_t)world->table[i].key);
+  }
+  qsort(world->cells, world->population, sizeof(struct cell), sparse_compare);
+}
+
+static void
+sparse_destroy (void *state)
+{
+  struct sparse_world *world = state;
+  free(world->cells);
+  free(world->table);
+  free(world);
+}
+
+const struct engine sparse_engine = {
+  .name = "sparse",
+  .unbounded = true,
+  .create = sparse_create,
+  .load_row = sparse_load_row,
+  .read_row = sparse_read_row,
+  .step = sparse_step,
+  .destroy = sparse_destroy,
+};
@@ -0,0 +1,164 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Per-generation statistics for --stats. Each line is
+
+  <generation> <population> <births> <deaths> <min_x> <min_y> <max_x> <max_y>
+
+with "-" for the four corners of the bounding box when nothing is alive, and
+births and deaths counted from the generation on the line before (so they are
+0 on the first line).
+
+The bit and simd engines count these while they step: right after a row of
+the next generation is computed, and while it and the row it replaces are
+still in L1, they add up its live, born and dead cells (with popcounts on the
+packed words, or byte sums in vector registers) and find its first and last
+live cells. All that is left here is to add up size row_stats. For the other
+engines every generation is read back with read_row() and compared, eight
+cells to a byte, with the one before, which is kept packed for that.
+*/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pattern.h"
+#include "stats.h"
+
+struct stats {
+  FILE *file;
+  const char *path;
+  unsigned long size;
+  unsigned long row_bytes;
+  // Set once a generation has been recorded.
+  bool recorded;
+  // The generation recorded last, and the one being read, packed by pack_cells().
+  unsigned char *previous;
+  unsigned char *packed;
+  // A row as read_row() gives it.
+  char *row;
+  struct row_stats *rows;
+};
+
+void
+sum_row_stats (const struct row_stats *rows, const unsigned long size, struct life_stats *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+  for (unsigned long y = 0; y < size; y++) {
+    const struct row_stats *row = &rows[y];
+    stats->births += row->births;
+    stats->deaths += row->deaths;
+    if (0 == row->population)
+      continue;
+
+    if (0 == stats->population) {
+      stats->min_x = row->first;
+      stats->max_x = row->last;
+      stats->min_y = y;
+    }
+    if (row->first < stats->min_x)
+      stats->min_x = row->first;
+    if (row->last > stats->max_x)
+      stats->max_x = row->last;
+    stats->max_y = y;
+    stats->population += row->population;
+  }
+}
+
+struct stats *
+stats_create (const char *path, const unsigned long size)
+{
+  struct stats *stats = malloc(sizeof(*stats));
+  stats->file = fopen(path, "w");
+  if (NULL == stats->file) {
+    fprintf(stderr, "Could not create %s: %s\n", path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  stats->path = path;
+  stats->size = size;
+  stats->row_bytes = (size + 7) / 8;
+  stats->recorded = false;
+  stats->previous = malloc(size * stats->row_bytes);
+  stats->packed = malloc(stats->row_bytes);
+  stats->row = malloc(size);
+  stats->rows = malloc(size * sizeof(struct row_stats));
+  fprintf(stats->file, "# generation population births deaths min_x min_y max_x max_y\n");
+  return stats;
+}
+
+// Counts the numbers of world by reading it, and keeps it for comparing the next generation with.
+static void
+stats_read (struct stats *stats, const struct engine *engine, const void *world, struct life_stats *counts)
+{
+  const unsigned long size = stats->size;
+  for (unsigned long y = 0; y < size; y++) {
+    engine->read_row(world, y, stats->row);
+    unsigned char *previous = stats->previous + y * stats->row_bytes;
+    pack_cells(stats->row, size, stats->packed);
+
+    struct row_stats *row = &stats->rows[y];
+    memset(row, 0, sizeof(*row));
+    for (unsigned long i = 0; i < stats->row_bytes; i++) {
+      const unsigned now = stats->packed[i];
+      const unsigned before = stats->recorded ? previous[i] : now;
+      row->population += (unsigned long)__builtin_popcount(now);
+      row->births += (unsigned long)__builtin_popcount(now & ~before);
+      row->deaths += (unsigned long)__builtin_popcount(before & ~now);
+      previous[i] = (unsigned char)now;
+    }
+    if (row->population > 0) {
+      row->first = (unsigned long)((const char *)memchr(stats->row, 1, size) - stats->row);
+      row->last = size - 1;
+      while (0 == stats->row[row->last])
+        row->last--;
+    }
+  }
+  sum_row_stats(stats->rows, size, counts);
+}
+
+void
+stats_record (struct stats *stats, const struct engine *engine, const void *world, const unsigned long generation)
+{
+  struct life_stats counts;
+  if (NULL != engine->stats && stats->recorded)
+    engine->stats(world, &counts);
+  else
+    stats_read(stats, engine, world, &counts);
+  stats->recorded = true;
+
+  if (0 == counts.population)
+    fprintf(stats->file, "%lu 0 %lu %lu - - - -\n", generation, counts.births, counts.deaths);
+  else
+    fprintf(stats->file, "%lu %lu %lu %lu %lu %lu %lu %lu\n", generation, counts.population, counts.births,
+            counts.deaths, counts.min_x, counts.min_y, counts.max_x, counts.max_y);
+}
+
+void
+stats_destroy (struct stats *stats)
+{
+  if (0 != fclose(stats->file)) {
+    fprintf(stderr, "Could not write %s: %s\n", stats->path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  free(stats->previous);
+  free(stats->packed);
+  free(stats->row);
+  free(stats->rows);
+  free(stats);
+}
@@ -0,0 +1,51 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIFE_STATS_H
+#define __LIFE_STATS_H
+
+#include "engine.h"
+
+// The numbers of one row of a step, which engines with a stats function keep.
+struct row_stats {
+  unsigned long population;
+  unsigned long births;
+  unsigned long deaths;
+  // The first and last live cells, if population > 0.
+  unsigned long first;
+  unsigned long last;
+};
+
+// Adds up the row_stats of the size rows of a world.
+void sum_row_stats (const struct row_stats *rows, const unsigned long size, struct life_stats *stats);
+
+/* A stream of one line of numbers per generation, for --stats. Engines with a
+   stats function give them for every generation after the first; for the
+   rest, each generation is read and compared with the one before. */
+struct stats;
+
+// Opens path for the stream and writes the header line.
+struct stats *stats_create (const char *path, const unsigned long size);
+// Writes the line of the current generation of world, which is generation number generation.
+void stats_record (struct stats *stats, const struct engine *engine, const void *world,
+                   const unsigned long generation);
+// Closes the stream.
+void stats_destroy (struct stats *stats);
+
+/* __LIFE_STATS_H */
+#endif
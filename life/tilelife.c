@@ -0,0 +1,217 @@
+/*
+    Conway's Game of Life (and rough edges in the code for teaching purposes)
+    Copyright (C) 2025 Nik Sultana
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Active-tile engine: the world is cut into TILE x TILE tiles and each tile
+remembers whether the last step changed it. A tile is only recomputed if it or
+one of its eight neighbouring tiles changed; otherwise its cells, and so its
+next generation, are the same as last time.
+
+Skipped tiles need no copying. The engine double-buffers, and a tile that did
+not change holds the same cells in both buffers, so swapping the buffers
+leaves it correct. The invariant is: a tile whose flag is clear holds the same
+cells in the current and the next buffer. Computing a tile re-establishes it
+when the result is unchanged, and skipping a tile preserves it.
+
+Cells are one char each with a dead border, as in the byte engine. With
+--wrap the border is a halo copied from the opposite edge after each step, and
+the tiles on one edge count those on the opposite edge as neighbours.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+
+// Tile edge, in cells.
+#define TILE 64
+
+struct tile_world {
+  unsigned long size;
+  // Bytes per row; cell (x, y) is at (y + 1) * stride + x + 1.
+  unsigned long stride;
+  // Tiles per row and per column.
+  unsigned long tiles;
+  // Holds every grid below.
+  struct arena *arena;
+  char *current;
+  char *next;
+  // One flag per tile: did the last step change it?
+  unsigned char *changed;
+  unsigned char *next_changed;
+  uint32_t rule;
+  bool wrap;
+};
+
+static void *
+tile_create (const struct life_config *config)
+{
+  struct tile_world *world = malloc(sizeof(*world));
+  world->size = config->size;
+  world->stride = config->size + 2;
+  world->tiles = (config->size + TILE - 1) / TILE;
+  world->rule = rule_mask(&config->rule);
+  world->wrap = config->wrap;
+  const unsigned long grid = world->stride * world->stride;
+  const unsigned long flags = world->tiles * world->tiles;
+  world->arena = arena_create(&config->arena, 2 * arena_bytes(grid) + 2 * arena_bytes(flags));
+  world->current = arena_alloc(world->arena, grid, 1);
+  world->next = arena_alloc(world->arena, grid, 1);
+  world->changed = arena_alloc(world->arena, flags, 1);
+  world->next_changed = arena_alloc(world->arena, flags, 1);
+  // The buffers differ until the first step, so every tile starts active.
+  memset(world->changed, 1, world->tiles * world->tiles);
+  return world;
+}
+
+// Refreshes the halo around row y of grid for --wrap.
+static void
+tile_wrap_row (const struct tile_world *world, char *grid, const unsigned long y)
+{
+  char *row = grid + (y + 1) * world->stride;
+  row[0] = row[world->size];
+  row[world->size + 1] = row[1];
+  if (0 == y)
+    memcpy(grid + (world->size + 1) * world->stride, row, world->stride);
+  if (world->size - 1 == y)
+    memcpy(grid, row, world->stride);
+}
+
+static void
+tile_load_row (void *state, const unsigned long y, const char *row)
+{
+  struct tile_world *world = state;
+  memcpy(world->current + (y + 1) * world->stride + 1, row, world->size);
+  memset(world->changed + y / TILE * world->tiles, 1, world->tiles);
+  if (world->wrap)
+    tile_wrap_row(world, world->current, y);
+}
+
+static void
+tile_read_row (const void *state, const unsigned long y, char *row)
+{
+  const struct tile_world *world = state;
+  memcpy(row, world->current + (y + 1) * world->stride + 1, world->size);
+}
+
+// Whether tile (tx, ty) or any tile around it changed in the last step.
+static bool
+tile_active (const struct tile_world *world, const unsigned long tx, const unsigned long ty)
+{
+  if (world->wrap) {
+    const unsigned long tiles = world->tiles;
+    for (unsigned long y = ty + tiles - 1; y <= ty + tiles + 1; y++) {
+      for (unsigned long x = tx + tiles - 1; x <= tx + tiles + 1; x++) {
+        if (world->changed[y % tiles * tiles + x % tiles])
+          return true;
+      }
+    }
+    return false;
+  }
+
+  const unsigned long x0 = tx > 0 ? tx - 1 : 0;
+  const unsigned long y0 = ty > 0 ? ty - 1 : 0;
+  const unsigned long x1 = tx + 1 < world->tiles ? tx + 1 : tx;
+  const unsigned long y1 = ty + 1 < world->tiles ? ty + 1 : ty;
+
+  for (unsigned long y = y0; y <= y1; y++) {
+    for (unsigned long x = x0; x <= x1; x++) {
+      if (world->changed[y * world->tiles + x])
+        return true;
+    }
+  }
+  return false;
+}
+
+/* Computes tile (tx, ty) into the next buffer with running column sums, as
+   the byte engine does, and returns whether any of its cells changed. */
+static unsigned char
+tile_step_tile (struct tile_world *world, const unsigned long tx, const unsigned long ty)
+{
+  const unsigned long stride = world->stride;
+  const unsigned long first_x = tx * TILE + 1;
+  const unsigned long last_x = first_x + TILE <= world->size + 1 ? first_x + TILE - 1 : world->size;
+  const unsigned long first_y = ty * TILE + 1;
+  const unsigned long last_y = first_y + TILE <= world->size + 1 ? first_y + TILE - 1 : world->size;
+  unsigned char changed = 0;
+
+  for (unsigned long y = first_y; y <= last_y; y++) {
+    const char *up = world->current + (y - 1) * stride;
+    const char *mid = up + stride;
+    const char *down = mid + stride;
+    char *out = world->next + y * stride;
+
+    int left = up[first_x - 1] + mid[first_x - 1] + down[first_x - 1];
+    int centre = up[first_x] + mid[first_x] + down[first_x];
+    for (unsigned long x = first_x; x <= last_x; x++) {
+      const int right = up[x + 1] + mid[x + 1] + down[x + 1];
+      const int ln = left + centre + right - mid[x];
+      out[x] = rule_next(world->rule, mid[x], ln);
+      changed |= (unsigned char)(out[x] ^ mid[x]);
+      left = centre;
+      centre = right;
+    }
+  }
+
+  return changed;
+}
+
+static void
+tile_step (void *state)
+{
+  struct tile_world *world = state;
+
+  for (unsigned long ty = 0; ty < world->tiles; ty++) {
+    for (unsigned long tx = 0; tx < world->tiles; tx++) {
+      unsigned char changed = 0;
+      if (tile_active(world, tx, ty))
+        changed = tile_step_tile(world, tx, ty);
+      world->next_changed[ty * world->tiles + tx] = changed;
+    }
+  }
+
+  char *tmp = world->current;
+  world->current = world->next;
+  world->next = tmp;
+  unsigned char *tmp_changed = world->changed;
+  world->changed = world->next_changed;
+  world->next_changed = tmp_changed;
+
+  if (world->wrap) {
+    for (unsigned long y = 0; y < world->size; y++)
+      tile_wrap_row(world, world->current, y);
+  }
+}
+
+static void
+tile_destroy (void *state)
+{
+  struct tile_world *world = state;
+  arena_destroy(world->arena);
+  free(world);
+}
+
+const struct engine tile_engine = {
+  .name = "tile",
+  .create = tile_create,
+  .load_row = tile_load_row,
+  .read_row = tile_read_row,
+  .step = tile_step,
+  .destroy = tile_destroy,
+};
@@ -16,10 +16,13 @@
 #   You should have received a copy of the GNU General Public License
 #   along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #
-# $ python3 visual_life.py
+# $ python3 visual_life.py life.out
+#
+# The file is either life's default text output or its --format=delta output.
 
 import argparse
 import curses
+import itertools
 import time
 
 
@@ -67,6 +70,67 @@ def process_step(step_data, stdscr):
       y = y + 1
 
 
+def decode_rle(lines, size):
+    grid = [[0] * size for _ in range(size)]
+    x = y = 0
+    count = ''
+    for line in lines:
+      if line.startswith('#') or line.startswith('x'):
+        continue
+      for c in line.strip():
+        if c.isdigit():
+          count += c
+          continue
+        n = int(count) if count else 1
+        count = ''
+        if '$' == c:
+          x = 0
+          y += n
+        elif '!' == c:
+          return grid
+        elif 'b' == c:
+          x += n
+        else:
+          for i in range(x, x + n):
+            grid[y][i] = 1
+          x += n
+    return grid
+
+
+# Rebuilds each generation of --format=delta output from its keyframes and flips.
+def delta_steps(lines):
+    grid = None
+    block = []
+
+    def finish():
+      nonlocal grid
+      if block[0].startswith('K'):
+        size = int(block[2].split(',')[0].split('=')[1])
+        grid = decode_rle(block[1:], size)
+      else:
+        for line in block[1:]:
+          fields = line.split()
+          row = grid[int(fields[0])]
+          for run in fields[1:]:
+            first, _, last = run.partition('-')
+            for x in range(int(first), int(last or first) + 1):
+              row[x] = 1 - row[x]
+      return grid
+
+    for line in lines:
+      if (line.startswith('K ') or line.startswith('D ')) and block:
+        yield finish()
+        block = []
+      block.append(line)
+    if block:
+      yield finish()
+
+
+def text_steps(lines):
+    for line in lines:
+      yield list(map((lambda l: list(map(lambda x: int(x), l.split(',')))), line.split()))
+
+
 def main(stdscr):
   curses.init_pair(1, curses.COLOR_WHITE, curses.COLOR_BLACK)
   curses.init_pair(2, curses.COLOR_YELLOW, curses.COLOR_BLACK)
@@ -80,8 +144,11 @@ def main(stdscr):
 
   step_number = 0
   with open(args.filename) as file:
-    for line in file:
-      row = list(map((lambda l: list(map(lambda x: int(x), l.split(',')))), line.split()))
+    # The first line tells the formats apart; the rest is read as it is needed.
+    first = file.readline()
+    lines = itertools.chain([first] if first else [], file)
+    steps = delta_steps(lines) if first.startswith('K ') else text_steps(lines)
+    for row in steps:
       process_step(row, stdscr)
       stdscr.addstr(0, len("LifeViz") + 1, "step " + str(step_number), curses.color_pair(2) | curses.A_BOLD)
       stdscr.refresh()